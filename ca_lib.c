@@ -2,103 +2,748 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include "ca_lib.h"
-#include "packages/hash_table/linked_list.h"
+#include "ca_lib_struct_def.h"
 #include "graphics/gfx/gfx.h"
 
-/*----USER NON-REACHAcarts.c ../database/db.c ../hash_and_list/hash_table.c ../hash_and_list/linked_list.cBLE DATATYPES----*/
+/*----USER NON-REACHABLE DATATYPES----*/
 
-struct cell_struct
+
+
+// A unit of work handed to a worker thread by 'run_jobs'
+typedef ca_lib_job_t job_function_t;
+
+// The cells of rows ['y_start', 'y_end') to be simulated by one job
+struct row_band
 {
-    size_t x;
-    size_t y;
-    data_t data;
+    ca_lib_grid_t *grid;
+    ca_lib_simulate_cell_t sim_func;
+    size_t y_start;
+    size_t y_end;
+};
+typedef struct row_band row_band_t;
+
+// The rows ['y_start', 'y_end') of a typed grid to be simulated by one job in 'ca_lib_simulate_rows'
+struct row_span_band
+{
+    ca_lib_grid_t *grid;
+    ca_lib_simulate_row_t row_func;
+    size_t y_start;
+    size_t y_end;
+    unsigned char *edges; // Copies of row 'y_start' - 1 and row 'y_end', taken before any band started
+    unsigned char *rows; // Scratch of the whole step - three rotating rows per worker thread
+};
+typedef struct row_span_band row_span_band_t;
+
+// One tile of the current phase in 'ca_lib_simulate_phased'
+struct tile_phase
+{
+    ca_lib_grid_t *grid;
+    ca_lib_simulate_cell_t sim_func;
+    unsigned int step;
+    size_t tx; // Tile coordinates
+    size_t ty;
+};
+typedef struct tile_phase tile_phase_t;
+
+// One tile of 'ca_lib_simulate_rows_blocked', to be computed or copied back
+struct blocked_tile
+{
+    ca_lib_grid_t *grid;
+    ca_lib_simulate_row_t row_func;
+    size_t steps;
+    unsigned char *rows; // The tile row's payloads 'steps' generations on - every tile writes its own part
+    unsigned char *scratch; // Two planes per worker thread for the tile and its margin, alternating between source and destination
+    size_t plane_bytes;
+    size_t tx; // Tile coordinates
+    size_t ty;
+    bool write_back; // Copy the tile's part of 'rows' over its payloads rather than compute it
 };
+typedef struct blocked_tile blocked_tile_t;
 
-typedef struct cell_struct cell_t;
+// The rows ['y_start', 'y_end') to be simulated by one job in 'ca_lib_simulate_sync'
+struct sync_band
+{
+    ca_lib_grid_t *grid;
+    ca_lib_simulate_neighbourhood_t sim_func;
+    ca_lib_neighbourhood_kind_t kind;
+    ca_lib_neighbourhood_t neighbourhood; // 'ptrs' holds one neighbourhood per worker thread
+    size_t y_start;
+    size_t y_end;
+};
+typedef struct sync_band sync_band_t;
 
-struct grid
+// The rows ['y_start', 'y_end') handled by one job in each phase of 'ca_lib_simulate_intents'
+struct intent_band
 {
-    void *meta_data; // data pertaining to the whole grid, muste be alloc:ed/freed by the user
-    size_t width; // Width of the simulation
-    size_t height; // Height of the simulation
-    ca_lib_data_alloc_function_t alloc_func; // A 'ca_lib_data_alloc_function_t' that allocates the cells' data
-    ca_lib_data_free_function_t free_func; // A 'ca_lib_data_free_function_t' that frees the cells' data
-    cell_t cells[]; // Allocate for 'witdh' * 'height' cells
+    ca_lib_grid_t *grid;
+    ca_lib_simulate_intent_t intent_func;
+    size_t y_start;
+    size_t y_end;
 };
+typedef struct intent_band intent_band_t;
 
-// Mainly used in i_to_pos to return 2 numbers
-struct position
+// The rows of blocks ['row_start', 'row_end') to be simulated by one job in 'ca_lib_simulate_margolus'
+struct block_band
 {
-    size_t x;
-    size_t y;
+    ca_lib_grid_t *grid;
+    ca_lib_simulate_block_t block_func;
+    size_t offset; // 0 or 1 - where the blocks start
+    size_t row_start;
+    size_t row_end;
+    unsigned char *saved; // Scratch - typed grids: four payloads per worker thread, the block's as they were handed over
 };
-typedef struct position pos_t;
+typedef struct block_band block_band_t;
+
+// Stream of 'ca_lib_random' that breaks ties between intents
+#define INTENT_TIE_STREAM 0x696e74656e74ull
 
+// The band engines split the rows into this many jobs per thread, so threads that finish early have work to steal
+#define BANDS_PER_THREAD 8
 
 /*----STATIC HELPER FUNCTIONS----*/
 
-// Convert array index of cell to cell's coordinates
-static pos_t i_to_pos(size_t width, int i)
+// Index of the cell at (x,y) in the halo padded 'cells' - x and y may be -1 (wrapped around) to reach the halo
+static size_t pos_to_i(ca_lib_grid_t *grid, size_t x, size_t y)
 {
-    pos_t pos;
-    pos.y = i / width; // C autimatically "floors" the result 
-    pos.x = i - (pos.y * width);
-    return pos;
+    return (x + 1) + (y + 1) * grid->stride;
 }
 
-static int pos_to_i(size_t width, size_t x, size_t y)
+// The public view of the cell at (x,y)
+static inline data_t cell_data(const cell_t *cell, size_t x, size_t y)
 {
-    return x + y * width;
+    data_t data;
+    data.x = x;
+    data.y = y;
+    data.size = cell->size;
+    data.ptr = cell->ptr;
+    return data;
+}
+
+// Map a coordinate outside of [0, 'size') to the cell the boundary takes it from - 'size' may not be 0
+static long boundary_coordinate(ca_lib_boundary_t boundary, long c, long size)
+{
+    if (boundary == CA_LIB_BOUNDARY_PERIODIC) { return ((c % size) + size) % size; }
+    // Reflective - mirrored in the edges, repeating every 2 * 'size'
+    long m = ((c % (2 * size)) + 2 * size) % (2 * size);
+    return m < size ? m : 2 * size - 1 - m;
 }
 
-static void fill_grid_empty_cells(ca_lib_grid_t *grid)
+// The 'data.ptr' of the cell at (x,y), or what the boundary puts there if it is outside of the grid
+static void *boundary_ptr(ca_lib_grid_t *grid, long x, long y)
 {
-    size_t width = grid->width;
-    // A cell with no data_ptr and undefined coordinates
-    cell_t empty_cell; 
-    empty_cell.data.size = 0;
-    empty_cell.data.ptr = NULL;
+    bool inside = x >= 0 && y >= 0 && x < (long)grid->width && y < (long)grid->height;
+    if (inside) { return grid->cells[pos_to_i(grid, x, y)].ptr; }
+    if (grid->boundary == CA_LIB_BOUNDARY_NONE) { return NULL; }
+    if (grid->boundary == CA_LIB_BOUNDARY_CONSTANT) { return grid->boundary_data; }
+    x = boundary_coordinate(grid->boundary, x, grid->width);
+    y = boundary_coordinate(grid->boundary, y, grid->height);
+    return grid->cells[pos_to_i(grid, x, y)].ptr;
+}
 
-    for (size_t i = 0; i < width * grid->height; i++)
+// Point the halo cell at (x,y) to what the boundary puts there
+static void refresh_halo_cell(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+    if (grid->boundary == CA_LIB_BOUNDARY_NONE || grid->boundary == CA_LIB_BOUNDARY_CONSTANT)
     {
-        pos_t pos = i_to_pos(width, i);
-        empty_cell.x = pos.x; // Working on a local variable is faster than one on the heap
-        empty_cell.y = pos.y;
-        empty_cell.data.x = pos.x;
-        empty_cell.data.y = pos.y;
-        grid->cells[i] = empty_cell; // Value transfer, not identity
+        cell->ptr = grid->boundary_data;
+        cell->size = grid->boundary_size;
+        return;
     }
-    
+    size_t sx = boundary_coordinate(grid->boundary, (long)x, grid->width);
+    size_t sy = boundary_coordinate(grid->boundary, (long)y, grid->height);
+    cell_t *source = &grid->cells[pos_to_i(grid, sx, sy)];
+    cell->ptr = source->ptr; // Aliases the source cell - never freed through the halo
+    cell->size = source->size;
+}
+
+// O(width + height), cheap next to a step - picks up 'data.ptr' changes made without the insert/move/switch/clear functions
+static void refresh_halo(ca_lib_grid_t *grid)
+{
+    if (grid->width == 0 || grid->height == 0) { return; }
+    for (size_t x = (size_t)-1; x != grid->width + 1; x++)
+    {
+        refresh_halo_cell(grid, x, (size_t)-1);
+        refresh_halo_cell(grid, x, grid->height);
+    }
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        refresh_halo_cell(grid, (size_t)-1, y);
+        refresh_halo_cell(grid, grid->width, y);
+    }
+}
+
+// Every engine starts its step here - 'ca_lib_random' draws differ from one generation to the next,
+// and the state the generation starts from is recorded for 'ca_lib_get_cycle_period'
+void ca_lib_begin_generation(ca_lib_grid_t *grid)
+{
+    refresh_halo(grid);
+    if (grid->hash_window)
+    {
+        grid->window_hashes[grid->window_next] = atomic_load_explicit(&grid->state_hash, memory_order_relaxed);
+        grid->window_generations[grid->window_next] = grid->generation;
+        grid->window_next = (grid->window_next + 1) % grid->hash_window;
+        if (grid->window_count < grid->hash_window) { grid->window_count++; }
+    }
+    grid->generation++;
+}
+
+// SplitMix64 finaliser
+static inline uint64_t mix(uint64_t z)
+{
+    z += 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// Refresh the halo cells mirroring (x,y) after its 'data' changed - only the edges have any
+static void update_halo(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    if (grid->boundary != CA_LIB_BOUNDARY_PERIODIC && grid->boundary != CA_LIB_BOUNDARY_REFLECTIVE) { return; }
+    if (x != 0 && y != 0 && x != grid->width - 1 && y != grid->height - 1) { return; }
+    // The halo cells that can mirror (x,y) lie on its own row and column, or diagonally off its corner
+    size_t xs[3] = {(size_t)-1, x, grid->width};
+    size_t ys[3] = {(size_t)-1, y, grid->height};
+    for (int j = 0; j < 3; j++)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            if (i == 1 && j == 1) { continue; }
+            size_t sx = xs[i] == x ? x : (size_t)boundary_coordinate(grid->boundary, (long)xs[i], (long)grid->width);
+            size_t sy = ys[j] == y ? y : (size_t)boundary_coordinate(grid->boundary, (long)ys[j], (long)grid->height);
+            if (sx == x && sy == y) { refresh_halo_cell(grid, xs[i], ys[j]); }
+        }
+    }
+}
+
+// FNV-1a
+static uint64_t hash_payload(const unsigned char *bytes, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Contribution of the cell at (x,y) to the state hash - empty cells contribute nothing
+static uint64_t cell_hash(const cell_t *cell, size_t x, size_t y)
+{
+    if (!cell->ptr) { return 0; }
+    return mix(mix(mix(x) ^ y) ^ hash_payload(cell->ptr, cell->size));
+}
+
+// Zobrist style - the state hash is the XOR of all cells' contributions, so a change swaps one contribution for another
+static void rehash_cell(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    if (!grid->cell_hashes) { return; }
+    uint64_t *contribution = &grid->cell_hashes[x + y * grid->width];
+    uint64_t hash = cell_hash(&grid->cells[pos_to_i(grid, x, y)], x, y);
+    if (hash == *contribution) { return; }
+    atomic_fetch_xor_explicit(&grid->state_hash, hash ^ *contribution, memory_order_relaxed);
+    *contribution = hash;
+}
+
+// Hash every cell from scratch and forget the recorded states
+static void rehash_grid(ca_lib_grid_t *grid)
+{
+    uint64_t state_hash = 0;
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            grid->cell_hashes[x + y * grid->width] = cell_hash(&grid->cells[pos_to_i(grid, x, y)], x, y);
+            state_hash ^= grid->cell_hashes[x + y * grid->width];
+        }
+    }
+    atomic_store_explicit(&grid->state_hash, state_hash, memory_order_relaxed);
+    grid->window_count = 0;
+    grid->window_next = 0;
+}
+
+// The class the cell's payload belongs to now
+static uint32_t classify_cell(ca_lib_grid_t *grid, const cell_t *cell)
+{
+    if (!cell->ptr) { return CA_LIB_UNCOUNTED; }
+    size_t class = grid->classify_func(cell->ptr, cell->size);
+    return class < grid->class_count ? (uint32_t)class : CA_LIB_UNCOUNTED;
+}
+
+// Move the cell at (x,y) from the class it was counted in to the one it belongs to now
+static void reclassify_cell(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    if (!grid->cell_classes) { return; }
+    uint32_t *counted = &grid->cell_classes[x + y * grid->width];
+    uint32_t class = classify_cell(grid, &grid->cells[pos_to_i(grid, x, y)]);
+    if (class == *counted) { return; }
+    if (*counted != CA_LIB_UNCOUNTED) { atomic_fetch_sub_explicit(&grid->populations[*counted], 1, memory_order_relaxed); }
+    if (class != CA_LIB_UNCOUNTED) { atomic_fetch_add_explicit(&grid->populations[class], 1, memory_order_relaxed); }
+    *counted = class;
+}
+
+// Classify every cell from scratch
+static void recount_grid(ca_lib_grid_t *grid)
+{
+    for (size_t c = 0; c < grid->class_count; c++)
+    {
+        atomic_store_explicit(&grid->populations[c], 0, memory_order_relaxed);
+    }
+    for (size_t i = 0; i < grid->width * grid->height; i++)
+    {
+        grid->cell_classes[i] = CA_LIB_UNCOUNTED;
+        reclassify_cell(grid, i % grid->width, i / grid->width);
+    }
+}
+
+// Whether anything needs to hear about the individual cells an engine changed
+static bool tracks_cells(ca_lib_grid_t *grid)
+{
+    return grid->cell_hashes || grid->cell_classes;
+}
+
+void ca_lib_track_cell_change(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    rehash_cell(grid, x, y);
+    reclassify_cell(grid, x, y);
+}
+
+// Keep the halo, the state hash and the populations in step with a cell whose contents changed
+static void cell_changed(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    update_halo(grid, x, y);
+    ca_lib_track_cell_change(grid, x, y);
+}
+
+// Flag the chunk containing (x,y) as changed - may be called from several workers at once
+static void mark_dirty(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    size_t c = (x / CA_LIB_CHUNK_SIZE) + (y / CA_LIB_CHUNK_SIZE) * grid->chunks_x;
+    atomic_store_explicit(&grid->dirty_chunks[c], true, memory_order_relaxed);
 }
 
 static void clear_cell(ca_lib_grid_t *grid, cell_t *cell)
 {
-    if (!cell->data.ptr) {return;}
-    cell->data.ptr = grid->free_func(cell->data.ptr);
-    cell->data.size = 0;
-    cell->data.x = cell->x;
-    cell->data.y = cell->y;
+    if (grid->cell_size)
+    {
+        memset(cell->ptr, 0, grid->cell_size); // Inline payloads are never freed, only zeroed
+        return;
+    }
+    if (!cell->ptr) {return;}
+    cell->ptr = grid->free_func(cell->ptr);
+    cell->size = 0;
+}
+
+// Swap 'size' bytes between 'a' and 'b' through a small stack buffer
+static void swap_bytes(unsigned char *a, unsigned char *b, size_t size)
+{
+    unsigned char tmp[64];
+    while (size > 0)
+    {
+        size_t n = size < sizeof(tmp) ? size : sizeof(tmp);
+        memcpy(tmp, a, n);
+        memcpy(a, b, n);
+        memcpy(b, tmp, n);
+        a += n;
+        b += n;
+        size -= n;
+    }
+}
+
+// Copy 'data_size' bytes of 'data_ptr' into an inline payload, zero-filling whatever is left
+static void write_inline(ca_lib_grid_t *grid, cell_t *cell, size_t data_size, void *data_ptr)
+{
+    size_t n = data_size < grid->cell_size ? data_size : grid->cell_size;
+    memmove(cell->ptr, data_ptr, n);
+    memset((unsigned char *)cell->ptr + n, 0, grid->cell_size - n);
+}
+
+// Start a new simulation step - every cell whose 'stamp' differs from the returned step is yet to be simulated
+static unsigned int next_step(ca_lib_grid_t *grid)
+{
+    grid->step++;
+    if (grid->step == 0) // Wrapped around, old stamps could collide with new steps
+    {
+        for (size_t i = 0; i < grid->stride * (grid->height + 2); i++)
+        {
+            grid->cells[i].stamp = 0;
+        }
+        grid->step = 1;
+    }
+    return grid->step;
+}
+
+// Store the 'ptr' and 'size' a rule assigned through the 'data_t' it was handed - 'ptr' and 'size' are the values it was handed
+// The cell itself is only touched if the rule assigned them, since it may have switched the cell's contents away meanwhile
+static inline void keep_assigned_data(ca_lib_grid_t *grid, cell_t *cell, const data_t *data, void *ptr, size_t size)
+{
+    if (data->ptr == ptr && data->size == size) { return; }
+    cell->ptr = data->ptr;
+    cell->size = data->size;
+    mark_dirty(grid, data->x, data->y);
+    cell_changed(grid, data->x, data->y);
+}
+
+// Run 'sim_func' on the cell at (x,y)
+static inline void simulate_cell(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func, cell_t *cell, size_t x, size_t y)
+{
+    data_t data = cell_data(cell, x, y);
+    void *ptr = data.ptr;
+    size_t size = data.size;
+    sim_func(grid, &data);
+    keep_assigned_data(grid, cell, &data, ptr, size);
+}
+
+// Runs 'job_func' on all 'job_count' jobs (each 'job_size' bytes large, stored in 'jobs') and returns when all are done
+// The grid's thread pool is started on first use and kept until the thread count or affinity changes
+static void run_jobs(ca_lib_grid_t *grid, job_function_t job_func, void *jobs, size_t job_size, size_t job_count)
+{
+    if (job_count == 0) { return; }
+    if (job_count == 1 || grid->thread_count == 1)
+    {
+        for (size_t i = 0; i < job_count; i++)
+        {
+            job_func((char *)jobs + i * job_size);
+        }
+        return;
+    }
+    if (!grid->threads) { grid->threads = ca_lib_create_thread_pool(grid->thread_count, grid->pin_threads); }
+    ca_lib_thread_pool_run(grid->threads, job_func, jobs, job_size, job_count); // Returns once every job is done - the barrier at the end of the step
+}
+
+// Grows 'buffer' to at least 'bytes' - scratch of the engines is kept with the grid between steps
+static void reserve_buffer(unsigned char **buffer, size_t *capacity, size_t bytes)
+{
+    if (bytes <= *capacity) { return; }
+    free(*buffer);
+    *buffer = malloc(bytes);
+    *capacity = bytes;
+}
+
+// Room for one neighbourhood of 'side' * 'side' pointers per worker thread - kept with the grid and only ever grown
+static void **reserve_neighbourhoods(ca_lib_grid_t *grid, size_t side)
+{
+    if (grid->thread_count * side * side > grid->neighbourhood_ptr_count)
+    {
+        free(grid->neighbourhood_ptrs);
+        grid->neighbourhood_ptr_count = grid->thread_count * side * side;
+        grid->neighbourhood_ptrs = malloc(grid->neighbourhood_ptr_count * sizeof(void *));
+    }
+    return grid->neighbourhood_ptrs;
+}
+
+// Index of the thread running the current job, for per-thread scratch - less than 'thread_count'
+static size_t current_worker(ca_lib_grid_t *grid)
+{
+    return grid->threads ? ca_lib_thread_pool_worker(grid->threads) : 0;
+}
+
+// Number of bands to split 'rows' rows into - a single one on one thread
+static size_t band_count(ca_lib_grid_t *grid, size_t rows)
+{
+    size_t bands = grid->thread_count == 1 ? 1 : grid->thread_count * BANDS_PER_THREAD;
+    return bands < rows ? bands : rows;
+}
+
+// Lists the tiles 'ca_lib_simulate_phased' hands out, phase by phase - redone whenever the tile size changes
+// Phase 0-3 covers the tiles with (tile x % 2, tile y % 2) == (phase % 2, phase / 2)
+static void plan_phase_tiles(ca_lib_grid_t *grid)
+{
+    size_t tiles_x = (grid->width + grid->tile_size - 1) / grid->tile_size;
+    size_t tiles_y = (grid->height + grid->tile_size - 1) / grid->tile_size;
+    free(grid->phase_tiles);
+    grid->phase_tiles = calloc(tiles_x * tiles_y + 1, sizeof(tile_phase_t));
+    size_t count = 0;
+    for (size_t phase = 0; phase < 4; phase++)
+    {
+        grid->phase_starts[phase] = count;
+        for (size_t ty = phase / 2; ty < tiles_y; ty += 2)
+        {
+            for (size_t tx = phase % 2; tx < tiles_x; tx += 2)
+            {
+                grid->phase_tiles[count++] = (tile_phase_t){grid, NULL, 0, tx, ty};
+            }
+        }
+    }
+    grid->phase_starts[4] = count;
+}
+
+// Splits the rows into the bands 'ca_lib_simulate_unabstract_parallel' hands out - redone whenever the thread count changes
+static void plan_row_bands(ca_lib_grid_t *grid)
+{
+    free(grid->row_bands);
+    grid->row_band_count = band_count(grid, grid->height);
+    grid->row_bands = calloc(grid->row_band_count, sizeof(row_band_t));
+    for (size_t b = 0; b < grid->row_band_count; b++)
+    {
+        grid->row_bands[b].grid = grid;
+        grid->row_bands[b].y_start = grid->height * b / grid->row_band_count;
+        grid->row_bands[b].y_end = grid->height * (b + 1) / grid->row_band_count;
+    }
+}
+
+// Splits the rows into the bands 'ca_lib_simulate_rows' hands out, along with their row buffers - redone whenever the
+// thread count changes
+static void plan_row_span_bands(ca_lib_grid_t *grid)
+{
+    size_t row_bytes = grid->width * grid->cell_size;
+    free(grid->row_span_bands);
+    free(grid->row_span_buffers);
+    grid->row_span_band_count = band_count(grid, grid->height);
+    grid->row_span_bands = calloc(grid->row_span_band_count, sizeof(row_span_band_t));
+    grid->row_span_buffers = malloc((grid->row_span_band_count * 2 + grid->thread_count * 3) * row_bytes + 1);
+    for (size_t b = 0; b < grid->row_span_band_count; b++)
+    {
+        row_span_band_t *band = &grid->row_span_bands[b];
+        band->grid = grid;
+        band->y_start = grid->height * b / grid->row_span_band_count;
+        band->y_end = grid->height * (b + 1) / grid->row_span_band_count;
+        band->edges = grid->row_span_buffers + b * 2 * row_bytes;
+        band->rows = grid->row_span_buffers + grid->row_span_band_count * 2 * row_bytes;
+    }
+}
+
+// Splits the rows into the bands 'ca_lib_simulate_sync' hands out - redone whenever the thread count changes
+static void plan_sync_bands(ca_lib_grid_t *grid)
+{
+    free(grid->sync_bands);
+    grid->sync_band_count = band_count(grid, grid->height);
+    grid->sync_bands = calloc(grid->sync_band_count, sizeof(sync_band_t));
+    for (size_t b = 0; b < grid->sync_band_count; b++)
+    {
+        grid->sync_bands[b].grid = grid;
+        grid->sync_bands[b].y_start = grid->height * b / grid->sync_band_count;
+        grid->sync_bands[b].y_end = grid->height * (b + 1) / grid->sync_band_count;
+    }
+}
+
+// Splits the rows into the bands every phase of 'ca_lib_simulate_intents' hands out - redone whenever the thread count changes
+static void plan_intent_bands(ca_lib_grid_t *grid)
+{
+    free(grid->intent_bands);
+    grid->intent_band_count = band_count(grid, grid->height);
+    grid->intent_bands = calloc(grid->intent_band_count, sizeof(intent_band_t));
+    for (size_t b = 0; b < grid->intent_band_count; b++)
+    {
+        grid->intent_bands[b].grid = grid;
+        grid->intent_bands[b].y_start = grid->height * b / grid->intent_band_count;
+        grid->intent_bands[b].y_end = grid->height * (b + 1) / grid->intent_band_count;
+    }
+}
+
+// Splits the rows of blocks into the bands 'ca_lib_simulate_margolus' hands out - redone whenever the thread count
+// changes. Planned for the blocks starting at row 0, the bands clamp the one row fewer of odd steps themselves
+static void plan_block_bands(ca_lib_grid_t *grid)
+{
+    size_t block_rows = grid->height / 2;
+    free(grid->block_bands);
+    free(grid->block_saved);
+    grid->block_band_count = band_count(grid, block_rows);
+    grid->block_bands = calloc(grid->block_band_count, sizeof(block_band_t));
+    grid->block_saved = malloc(grid->thread_count * 4 * grid->cell_size + 1);
+    for (size_t b = 0; b < grid->block_band_count; b++)
+    {
+        grid->block_bands[b].grid = grid;
+        grid->block_bands[b].row_start = block_rows * b / grid->block_band_count;
+        grid->block_bands[b].row_end = block_rows * (b + 1) / grid->block_band_count;
+        grid->block_bands[b].saved = grid->block_saved;
+    }
+}
+
+static void simulate_row_band(void *job)
+{
+    row_band_t *band = job;
+    for (size_t y = band->y_start; y < band->y_end; y++)
+    {
+        cell_t *row = &band->grid->cells[pos_to_i(band->grid, 0, y)];
+        for (size_t x = 0; x < band->grid->width; x++)
+        {
+            simulate_cell(band->grid, band->sim_func, &row[x], x, y);
+        }
+    }
+}
+
+// Simulate every cell in the tile at tile coordinates (tx, ty) which hasn't been simulated this step
+static void simulate_tile(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func, unsigned int step, size_t tx, size_t ty)
+{
+    size_t x_end = (tx + 1) * grid->tile_size < grid->width ? (tx + 1) * grid->tile_size : grid->width;
+    size_t y_end = (ty + 1) * grid->tile_size < grid->height ? (ty + 1) * grid->tile_size : grid->height;
+    for (size_t y = ty * grid->tile_size; y < y_end; y++)
+    {
+        for (size_t x = tx * grid->tile_size; x < x_end; x++)
+        {
+            cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+            if (cell->stamp == step) { continue; } // Already simulated this step
+            cell->stamp = step;
+            simulate_cell(grid, sim_func, cell, x, y);
+        }
+    }
+}
+
+static void simulate_tile_phase(void *job)
+{
+    tile_phase_t *tp = job;
+    simulate_tile(tp->grid, tp->sim_func, tp->step, tp->tx, tp->ty);
+}
+
+// Copies the tile at (tx,ty) with a 'steps' wide margin into scratch and advances it 'steps' generations there. The rows
+// handed to the rule end at the margin, so its outermost cells are computed wrong - each step a cell further in, which is
+// why the computed span shrinks by a cell per step. What's left after the last step is the tile. Margins at the grid's
+// edges are empty and never shrink, those ends are the grid's own.
+static void simulate_blocked_tile(blocked_tile_t *bt)
+{
+    ca_lib_grid_t *grid = bt->grid;
+    size_t cs = grid->cell_size;
+    unsigned char *planes[2];
+    planes[0] = bt->scratch + current_worker(grid) * 2 * bt->plane_bytes;
+    planes[1] = planes[0] + bt->plane_bytes;
+    size_t x0 = bt->tx * grid->tile_size, y0 = bt->ty * grid->tile_size;
+    size_t x1 = x0 + grid->tile_size < grid->width ? x0 + grid->tile_size : grid->width;
+    size_t y1 = y0 + grid->tile_size < grid->height ? y0 + grid->tile_size : grid->height;
+    size_t ex0 = x0 > bt->steps ? x0 - bt->steps : 0, ey0 = y0 > bt->steps ? y0 - bt->steps : 0;
+    size_t ex1 = x1 + bt->steps < grid->width ? x1 + bt->steps : grid->width;
+    size_t ey1 = y1 + bt->steps < grid->height ? y1 + bt->steps : grid->height;
+    size_t stride = (ex1 - ex0) * cs;
+
+    for (size_t y = ey0; y < ey1; y++)
+    {
+        memcpy(planes[0] + (y - ey0) * stride, grid->payloads + (y * grid->width + ex0) * cs, stride);
+    }
+    for (size_t s = 0; s < bt->steps; s++)
+    {
+        // The span still right in the source plane
+        size_t lo = ex0 > 0 ? ex0 + s : 0, hi = ex1 < grid->width ? ex1 - s : ex1;
+        size_t top = ey0 > 0 ? ey0 + s : 0, bottom = ey1 < grid->height ? ey1 - s : ey1;
+        for (size_t y = top; y < bottom; y++)
+        {
+            size_t offset = (y - ey0) * stride + (lo - ex0) * cs;
+            const unsigned char *row = planes[s % 2] + offset;
+            bt->row_func(grid, y, hi - lo, y > top ? row - stride : NULL, row, y + 1 < bottom ? row + stride : NULL, planes[(s + 1) % 2] + offset);
+        }
+    }
+    for (size_t y = y0; y < y1; y++)
+    {
+        memcpy(bt->rows + ((y - y0) * grid->width + x0) * cs, planes[bt->steps % 2] + (y - ey0) * stride + (x0 - ex0) * cs, (x1 - x0) * cs);
+    }
+}
+
+// Flag the chunks of the cells ['x_start', 'x_end') of row 'y' where 'old' and 'new' differ - both start at 'x_start'
+static void mark_changed_span(ca_lib_grid_t *grid, size_t y, size_t x_start, size_t x_end, const unsigned char *old, const unsigned char *new)
+{
+    for (size_t x = x_start; x < x_end;)
+    {
+        size_t chunk_end = (x / CA_LIB_CHUNK_SIZE + 1) * CA_LIB_CHUNK_SIZE;
+        size_t end = chunk_end < x_end ? chunk_end : x_end;
+        size_t offset = (x - x_start) * grid->cell_size;
+        if (memcmp(old + offset, new + offset, (end - x) * grid->cell_size) != 0) { mark_dirty(grid, x, y); }
+        x = end;
+    }
+    for (size_t x = x_start; tracks_cells(grid) && x < x_end; x++)
+    {
+        size_t offset = (x - x_start) * grid->cell_size;
+        if (memcmp(old + offset, new + offset, grid->cell_size) != 0) { ca_lib_track_cell_change(grid, x, y); }
+    }
+}
+
+// Copies the tile's result over its payloads - once no tile still to be computed reads them
+static void write_back_blocked_tile(blocked_tile_t *bt)
+{
+    ca_lib_grid_t *grid = bt->grid;
+    size_t cs = grid->cell_size;
+    size_t x0 = bt->tx * grid->tile_size, y0 = bt->ty * grid->tile_size;
+    size_t x1 = x0 + grid->tile_size < grid->width ? x0 + grid->tile_size : grid->width;
+    size_t y1 = y0 + grid->tile_size < grid->height ? y0 + grid->tile_size : grid->height;
+    for (size_t y = y0; y < y1; y++)
+    {
+        unsigned char *payloads = grid->payloads + (y * grid->width + x0) * cs;
+        const unsigned char *result = bt->rows + ((y - y0) * grid->width + x0) * cs;
+        mark_changed_span(grid, y, x0, x1, payloads, result);
+        memcpy(payloads, result, (x1 - x0) * cs);
+    }
 }
 
-static void alloc_data_allocated(void **data_loc, void *data, size_t data_size)
+static void run_blocked_tile(void *job)
 {
-    *data_loc = data; // data_loc has already been alloc:ed
+    blocked_tile_t *bt = job;
+    if (bt->write_back) { write_back_blocked_tile(bt); }
+    else { simulate_blocked_tile(bt); }
 }
 
-static void dont_free(void **data_loc)
+// Row i of the band is copied into scratch row i % 3 right before it is needed as 'below', which only
+// overwrites the copy of row i - 3 - the band's boundary rows come from 'edges' since neighbouring bands change them
+static void simulate_row_span_band(void *job)
 {
-    return; // Reject work, do nothing, sleep.
+    row_span_band_t *band = job;
+    ca_lib_grid_t *grid = band->grid;
+    size_t row_bytes = grid->width * grid->cell_size;
+    unsigned char *above_edge = band->y_start > 0 ? band->edges : NULL;
+    unsigned char *below_edge = band->y_end < grid->height ? band->edges + row_bytes : NULL;
+    unsigned char *rows = band->rows + current_worker(grid) * 3 * row_bytes;
+
+    memcpy(rows, grid->payloads + band->y_start * row_bytes, row_bytes);
+    for (size_t y = band->y_start; y < band->y_end; y++)
+    {
+        size_t i = y - band->y_start;
+        unsigned char *row = rows + (i % 3) * row_bytes;
+        unsigned char *above = i > 0 ? rows + ((i - 1) % 3) * row_bytes : above_edge;
+        unsigned char *below = below_edge;
+        if (y + 1 < band->y_end)
+        {
+            below = rows + ((i + 1) % 3) * row_bytes;
+            memcpy(below, grid->payloads + (y + 1) * row_bytes, row_bytes);
+        }
+        unsigned char *out = grid->payloads + y * row_bytes;
+        band->row_func(grid, y, grid->width, above, row, below, out);
+        mark_changed_span(grid, y, 0, grid->width, row, out);
+    }
 }
 
-static ioopm_list_t *create_cell_buffer(ca_lib_grid_t *grid)
+// Fill 'neighbourhood' with the cells around (x,y) - anything outside of the shape, or of a grid without boundary, is NULL
+static void gather_neighbourhood(ca_lib_grid_t *grid, ca_lib_neighbourhood_kind_t kind, size_t x, size_t y, ca_lib_neighbourhood_t *neighbourhood)
 {
-    ioopm_list_t *buf = ioopm_linked_list_create(alloc_data_allocated, dont_free);
-    for (size_t i = 0; i < grid->height * grid->width; i++)
+    size_t r = neighbourhood->radius;
+    size_t side = neighbourhood->side;
+    void **ptrs = neighbourhood->ptrs;
+
+    // Fast path - the whole square is inside the grid and its halo, which always covers radius 1
+    if (x + 1 >= r && y + 1 >= r && x + r <= grid->width && y + r <= grid->height)
+    {
+        cell_t *row = &grid->cells[pos_to_i(grid, x - r, y - r)];
+        for (size_t dy = 0; dy < side; dy++, row += grid->stride)
+        {
+            for (size_t dx = 0; dx < side; dx++)
+            {
+                ptrs[dy * side + dx] = row[dx].ptr;
+            }
+        }
+    }
+    else
+    {
+        for (size_t dy = 0; dy < side; dy++)
+        {
+            for (size_t dx = 0; dx < side; dx++)
+            {
+                ptrs[dy * side + dx] = boundary_ptr(grid, (long)(x + dx) - (long)r, (long)(y + dy) - (long)r);
+            }
+        }
+    }
+
+    if (kind == CA_LIB_VON_NEUMANN)
     {
-        ioopm_linked_list_append(buf, (void *)(&grid->cells[i].data), sizeof(data_t));
+        for (size_t dy = 0; dy < side; dy++)
+        {
+            for (size_t dx = 0; dx < side; dx++)
+            {
+                size_t distance = (dx > r ? dx - r : r - dx) + (dy > r ? dy - r : r - dy);
+                if (distance > r) { ptrs[dy * side + dx] = NULL; }
+            }
+        }
     }
-    return buf;
 }
 
 /*----PUBLIC LIBRARY FUNCTIONS----*/
@@ -120,21 +765,107 @@ void *ca_lib_free_simple_ptr (void *data_ptr)
     free(data_ptr);
     return NULL;
 }
+
+void *ca_lib_alloc_pooled_ptr (void *data_ptr, size_t data_size)
+{
+    return ca_lib_pool_alloc(ca_lib_shared_pool(), data_ptr, data_size);
+}
+
+// Payloads know their pool, whichever grid they were allocated for
+void *ca_lib_free_pooled_ptr (void *data_ptr)
+{
+    ca_lib_pool_free(data_ptr);
+    return NULL;
+}
+
+void *ca_lib_alloc_interned_ptr (void *data_ptr, size_t data_size)
+{
+    return ca_lib_intern(ca_lib_shared_intern_table(), data_ptr, data_size);
+}
+
+void *ca_lib_free_interned_ptr (void *data_ptr)
+{
+    ca_lib_release_interned(data_ptr);
+    return NULL;
+}
+
+void *ca_lib_alloc_arena_ptr (void *data_ptr, size_t data_size)
+{
+    return ca_lib_arena_alloc(ca_lib_shared_arena(), data_ptr, data_size);
+}
+
+// Payloads of a grid's own arena are only released all at once, by 'ca_lib_reset_grid' and 'ca_lib_destroy_grid' -
+// the shared arena behind 'ca_lib_alloc_arena_ptr' is never released
+void *ca_lib_free_arena_ptr (void *data_ptr)
+{
+    (void)data_ptr;
+    return NULL;
+}
 /*--------------------------*/
 
-ca_lib_grid_t *ca_lib_create_grid(void *meta_data, size_t width, size_t height, ca_lib_data_alloc_function_t alloc_func, ca_lib_data_free_function_t free_func)
+// Allocates a grid with empty cells and default settings, followed by 'payloads_mem_size' bytes of zeroed memory
+static ca_lib_grid_t *create_grid(void *meta_data, size_t width, size_t height, size_t payloads_mem_size)
 {
-    size_t cells_mem_size = width * height * sizeof(cell_t); // memory required for the cells
-    ca_lib_grid_t *grid = calloc(1, cells_mem_size + sizeof(ca_lib_grid_t));
+    size_t cells_mem_size = (width + 2) * (height + 2) * sizeof(cell_t); // memory required for the cells and their halo - zeroed cells are empty
+    ca_lib_grid_t *grid = calloc(1, sizeof(ca_lib_grid_t) + cells_mem_size + payloads_mem_size);
 
     grid->meta_data = meta_data;
 
     grid->height = height;
     grid->width = width;
+    grid->stride = width + 2;
+    grid->thread_count = 1;
+    grid->tile_size = CA_LIB_DEFAULT_TILE_SIZE;
+
+    // Every chunk starts out dirty so the first active step visits the whole grid
+    grid->chunks_x = (width + CA_LIB_CHUNK_SIZE - 1) / CA_LIB_CHUNK_SIZE;
+    grid->chunks_y = (height + CA_LIB_CHUNK_SIZE - 1) / CA_LIB_CHUNK_SIZE;
+    grid->dirty_chunks = calloc(grid->chunks_x * grid->chunks_y, sizeof(atomic_bool));
+    grid->active_chunks = calloc(grid->chunks_x * grid->chunks_y, sizeof(bool));
+    for (size_t c = 0; c < grid->chunks_x * grid->chunks_y; c++)
+    {
+        atomic_init(&grid->dirty_chunks[c], true);
+    }
+
+    return grid;
+}
+
+ca_lib_grid_t *ca_lib_create_grid(void *meta_data, size_t width, size_t height, ca_lib_data_alloc_function_t alloc_func, ca_lib_data_free_function_t free_func)
+{
+    ca_lib_grid_t *grid = create_grid(meta_data, width, height, 0);
+
     grid->alloc_func = alloc_func;
     grid->free_func = free_func;
+    if (alloc_func == ca_lib_alloc_pooled_ptr) { grid->pool = ca_lib_create_pool(); }
+    // Interned grids share the table of the allocator pair, so payloads a rule allocates through the pair are the same
+    // pointers as the ones inserted
+    if (alloc_func == ca_lib_alloc_interned_ptr) { grid->interns = ca_lib_shared_intern_table(); }
+    if (alloc_func == ca_lib_alloc_arena_ptr) { grid->arena = ca_lib_create_arena(); }
+
+    return grid;
+}
+
+ca_lib_grid_t *ca_lib_create_typed_grid(void *meta_data, size_t width, size_t height, size_t cell_size)
+{
+    if (cell_size > UINT32_MAX) { return NULL; } // Doesn't fit the cells' 32-bit size
+    size_t payloads_mem_size = width * height * cell_size; // memory required for the inline payloads
+    ca_lib_grid_t *grid = create_grid(meta_data, width, height, payloads_mem_size);
+
+    grid->alloc_func = NULL; // Payloads live in the grid allocation
+    grid->free_func = NULL;
+    grid->cell_size = cell_size;
+    grid->payloads = (unsigned char *)&grid->cells[(width + 2) * (height + 2)];
 
-    fill_grid_empty_cells(grid);
+    // Every cell permanently points at its own (zeroed) slot - the payloads have no halo
+    for (size_t y = 0; y < height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+        {
+            cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+            cell->ptr = grid->payloads + (x + y * width) * cell_size;
+            cell->size = cell_size;
+        }
+    }
 
     return grid;
 }
@@ -154,28 +885,254 @@ size_t ca_lib_get_grid_height(ca_lib_grid_t *grid)
     return grid->height;
 }
 
+void ca_lib_set_thread_count(ca_lib_grid_t *grid, size_t thread_count)
+{
+    grid->thread_count = thread_count > 0 ? thread_count : 1;
+    if (grid->threads && ca_lib_thread_pool_size(grid->threads) != grid->thread_count)
+    {
+        grid->threads = ca_lib_destroy_thread_pool(grid->threads); // Restarted with the new count on next use
+    }
+    // Engines that already ran keep their bands with the grid - split the rows anew
+    if (grid->back) { plan_sync_bands(grid); }
+    if (grid->row_bands) { plan_row_bands(grid); }
+    if (grid->row_span_bands) { plan_row_span_bands(grid); }
+    if (grid->intent_bands) { plan_intent_bands(grid); }
+    if (grid->block_bands) { plan_block_bands(grid); }
+}
+
+void ca_lib_set_thread_affinity(ca_lib_grid_t *grid, bool pin)
+{
+    if (pin == grid->pin_threads) { return; }
+    grid->pin_threads = pin;
+    if (grid->threads) { grid->threads = ca_lib_destroy_thread_pool(grid->threads); }
+}
+
+void ca_lib_run_jobs(ca_lib_grid_t *grid, ca_lib_job_t job_func, void *jobs, size_t job_size, size_t job_count)
+{
+    run_jobs(grid, job_func, jobs, job_size, job_count);
+}
+
+void ca_lib_set_local_rule(ca_lib_grid_t *grid, bool local_rule)
+{
+    grid->local_rule = local_rule;
+}
+
+void ca_lib_set_tile_size(ca_lib_grid_t *grid, size_t tile_size)
+{
+    grid->tile_size = tile_size > 0 ? tile_size : 1;
+    if (grid->phase_tiles) { plan_phase_tiles(grid); }
+}
+
+void ca_lib_enable_double_buffer(ca_lib_grid_t *grid)
+{
+    if (grid->cell_size == 0 || grid->back) { return; }
+    grid->back = malloc(grid->width * grid->height * grid->cell_size);
+    plan_sync_bands(grid);
+}
+
+void ca_lib_set_boundary(ca_lib_grid_t *grid, ca_lib_boundary_t boundary, size_t data_size, void *data_ptr)
+{
+    free(grid->boundary_data);
+    grid->boundary_data = NULL;
+    grid->boundary_size = 0;
+    grid->boundary = boundary;
+    if (boundary == CA_LIB_BOUNDARY_CONSTANT)
+    {
+        grid->boundary_data = malloc(data_size > 0 ? data_size : 1);
+        if (data_ptr) { memcpy(grid->boundary_data, data_ptr, data_size); }
+        grid->boundary_size = data_size;
+    }
+    refresh_halo(grid);
+}
+
+void ca_lib_set_seed(ca_lib_grid_t *grid, uint64_t seed)
+{
+    grid->seed = seed;
+}
+
+uint64_t ca_lib_get_generation(ca_lib_grid_t *grid)
+{
+    return grid->generation;
+}
+
+void ca_lib_enable_state_hash(ca_lib_grid_t *grid, size_t window)
+{
+    free(grid->cell_hashes);
+    free(grid->window_hashes);
+    free(grid->window_generations);
+    grid->cell_hashes = NULL;
+    grid->window_hashes = NULL;
+    grid->window_generations = NULL;
+    grid->hash_window = 0;
+    if (window == 0) { return; }
+
+    grid->cell_hashes = calloc(grid->width * grid->height, sizeof(uint64_t));
+    grid->window_hashes = calloc(window, sizeof(uint64_t));
+    grid->window_generations = calloc(window, sizeof(uint64_t));
+    grid->hash_window = window;
+    rehash_grid(grid);
+}
+
+uint64_t ca_lib_get_state_hash(ca_lib_grid_t *grid)
+{
+    return atomic_load_explicit(&grid->state_hash, memory_order_relaxed);
+}
+
+// Newest recorded state first, so the shortest period is found
+size_t ca_lib_get_cycle_period(ca_lib_grid_t *grid)
+{
+    uint64_t hash = atomic_load_explicit(&grid->state_hash, memory_order_relaxed);
+    for (size_t i = 1; i <= grid->window_count; i++)
+    {
+        size_t slot = (grid->window_next + grid->hash_window - i) % grid->hash_window;
+        if (grid->window_hashes[slot] == hash) { return grid->generation - grid->window_generations[slot]; }
+    }
+    return 0;
+}
+
+void ca_lib_set_classifier(ca_lib_grid_t *grid, size_t class_count, ca_lib_classify_data_t classify_func)
+{
+    free(grid->cell_classes);
+    free(grid->populations);
+    grid->cell_classes = NULL;
+    grid->populations = NULL;
+    grid->classify_func = NULL;
+    grid->class_count = 0;
+    if (!classify_func || class_count == 0 || class_count > CA_LIB_UNCOUNTED) { return; }
+
+    grid->classify_func = classify_func;
+    grid->class_count = class_count;
+    grid->cell_classes = malloc(grid->width * grid->height * sizeof(uint32_t));
+    grid->populations = calloc(class_count, sizeof(atomic_size_t));
+    recount_grid(grid);
+}
+
+size_t ca_lib_get_population(ca_lib_grid_t *grid, size_t class)
+{
+    if (class >= grid->class_count) { return 0; }
+    return atomic_load_explicit(&grid->populations[class], memory_order_relaxed);
+}
+
+size_t ca_lib_run_until_stable(ca_lib_grid_t *grid, ca_lib_simulate_grid_t sim_func, size_t max_steps)
+{
+    if (!grid->hash_window) { return 0; }
+    size_t steps = 0;
+    while (steps < max_steps)
+    {
+        sim_func(grid);
+        steps++;
+        if (ca_lib_get_cycle_period(grid)) { break; }
+    }
+    return steps;
+}
+
+// Stateless - every draw is a hash of its whole key, so no state is shared between threads and the
+// result doesn't depend on the order the cells are simulated in
+uint64_t ca_lib_random(ca_lib_grid_t *grid, size_t x, size_t y, uint64_t stream)
+{
+    uint64_t z = mix(grid->seed ^ mix(grid->generation));
+    z = mix(z ^ x);
+    z = mix(z ^ y);
+    return mix(z ^ stream);
+}
+
+void ca_lib_mark_cell_dirty(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    if (!ca_lib_check_limits(grid, x, y)) { return; }
+    mark_dirty(grid, x, y);
+    cell_changed(grid, x, y);
+}
+
 bool ca_lib_check_limits(ca_lib_grid_t *grid, size_t x, size_t y)
 {
     return ((x >= 0 && x < grid->width) && (y >= 0 && y < grid->height));
 }
 
-// Frees the given grid and its cells' 'data_ptr' pointer and returns NULL
-ca_lib_grid_t *ca_lib_destroy_grid(ca_lib_grid_t *grid)
+// Free all cells' 'data_ptr' pointers, leaving the cells themselves as they are - inline payloads go with the grid
+// Payloads from the grid's own pool or arena are released all at once, and the allocator destroyed - interned payloads
+// each drop their reference to the shared table
+static void release_payloads(ca_lib_grid_t *grid)
 {
-    // Free all cells' 'data_ptr' pointers
-    for (size_t i = 0; i < grid->height * grid->height; i++)
+    for (size_t y = 0; !grid->cell_size && !grid->arena && y < grid->height; y++)
     {
-        clear_cell(grid, &grid->cells[i]);
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+            if (grid->pool && ca_lib_pool_owns(grid->pool, cell->ptr)) { continue; } // Released below along with the pool
+            clear_cell(grid, cell); // The halo only aliases these
+        }
     }
+    if (grid->pool) { grid->pool = ca_lib_destroy_pool(grid->pool); }
+    if (grid->arena) { grid->arena = ca_lib_destroy_arena(grid->arena); }
+}
+
+// Frees the given grid and its cells' 'data_ptr' pointer and returns NULL
+ca_lib_grid_t *ca_lib_destroy_grid(ca_lib_grid_t *grid)
+{
+    release_payloads(grid);
+    free(grid->boundary_data);
+    free(grid->cell_hashes);
+    free(grid->window_hashes);
+    free(grid->window_generations);
+    free(grid->cell_classes);
+    free(grid->populations);
+    free(grid->back);
+    free(grid->phase_tiles);
+    free(grid->row_bands);
+    free(grid->row_span_bands);
+    free(grid->row_span_buffers);
+    free(grid->sync_bands);
+    free(grid->neighbourhood_ptrs);
+    free(grid->blocked_rows);
+    free(grid->blocked_planes);
+    free(grid->live_rows);
+    free(grid->intents);
+    free(grid->winners);
+    free(grid->intent_bands);
+    free(grid->block_bands);
+    free(grid->block_saved);
+    if (grid->threads) { grid->threads = ca_lib_destroy_thread_pool(grid->threads); }
+    free(grid->dirty_chunks);
+    free(grid->active_chunks);
     free(grid);
     return NULL;
 }
 
+// Arena grids rewind their arena, keeping its memory for the next run - the cells themselves are wiped by one memset
+void ca_lib_reset_grid(ca_lib_grid_t *grid)
+{
+    if (grid->cell_size)
+    {
+        memset(grid->payloads, 0, grid->width * grid->height * grid->cell_size);
+    }
+    else
+    {
+        if (grid->arena) { ca_lib_rewind_arena(grid->arena); }
+        else
+        {
+            bool pooled = grid->pool != NULL;
+            release_payloads(grid);
+            if (pooled) { grid->pool = ca_lib_create_pool(); }
+        }
+        memset(grid->cells, 0, grid->stride * (grid->height + 2) * sizeof(cell_t));
+        refresh_halo(grid);
+    }
+    for (size_t c = 0; c < grid->chunks_x * grid->chunks_y; c++)
+    {
+        atomic_store_explicit(&grid->dirty_chunks[c], true, memory_order_relaxed);
+    }
+    if (grid->cell_hashes) { rehash_grid(grid); }
+    if (grid->cell_classes) { recount_grid(grid); }
+}
+
 //Empty cell at (x,y), freeing it's data
 void ca_lib_clear_cell(ca_lib_grid_t *grid, size_t x, size_t y)
 {
-    cell_t *cellxy = &grid->cells[pos_to_i(grid->width, x, y)];
+    if (!ca_lib_check_limits(grid, x, y)) { return; } // The halo only aliases payloads
+    cell_t *cellxy = &grid->cells[pos_to_i(grid, x, y)];
+    mark_dirty(grid, x, y);
     clear_cell(grid, cellxy);
+    cell_changed(grid, x, y);
 }
 
 // Inserts the given data_ptr into the cell at (x,y) in 'grid'
@@ -186,16 +1143,28 @@ void ca_lib_insert_cell(ca_lib_grid_t *grid, size_t x, size_t y, size_t data_siz
         return;
     }
 
-    cell_t *cell = &grid->cells[pos_to_i(grid->width, x, y)]; // Get pointer to cell at (x,y)
-    cell->data.size = data_size; // Change cell's data_size
-    cell->data.x = x;
-    cell->data.y = y;
+    cell_t *cell = &grid->cells[pos_to_i(grid, x, y)]; // Get pointer to cell at (x,y)
+    mark_dirty(grid, x, y);
+
+    if (grid->cell_size)
+    {
+        write_inline(grid, cell, data_size, data_ptr);
+        cell_changed(grid, x, y);
+        return;
+    }
+
+    if (data_size > UINT32_MAX) { return; } // Doesn't fit the cell's 32-bit size
+    cell->size = data_size; // Change cell's data_size
 
     // Free previous data if present
-    if (cell->data.ptr) { cell->data.ptr = grid->free_func(cell->data.ptr); }
+    if (cell->ptr) { cell->ptr = grid->free_func(cell->ptr); }
 
     // Allocate for new data
-    cell->data.ptr = grid->alloc_func(data_ptr, data_size);
+    if (grid->pool) { cell->ptr = ca_lib_pool_alloc(grid->pool, data_ptr, data_size); }
+    else if (grid->interns) { cell->ptr = ca_lib_intern(grid->interns, data_ptr, data_size); }
+    else if (grid->arena) { cell->ptr = ca_lib_arena_alloc(grid->arena, data_ptr, data_size); }
+    else { cell->ptr = grid->alloc_func(data_ptr, data_size); }
+    cell_changed(grid, x, y);
 }
 
 // Moves the cell's data at (x1,y1) to (x2, y2) - overwriting and freeing any potential cell at (x2, y2)
@@ -206,15 +1175,68 @@ void ca_lib_move_cell(ca_lib_grid_t *grid, size_t x1, size_t y1, size_t x2, size
         return;
     }
 
-    // TODO: Optimise: don't need to clear and reinsert, just moooooove
-
     // Grab cell at (x1, y1)
-    cell_t *cellxy = &grid->cells[pos_to_i(grid->width, x1, y1)];
+    cell_t *cellxy = &grid->cells[pos_to_i(grid, x1, y1)];
+    mark_dirty(grid, x1, y1);
+    mark_dirty(grid, x2, y2);
 
-    // Insert data from cellxy at (x2, y2)
-    ca_lib_insert_cell(grid, x2, y2, cellxy->data.size, cellxy->data.ptr);
+    if (grid->cell_size)
+    {
+        if (x1 == x2 && y1 == y2) { return; }
+        cell_t *dest = &grid->cells[pos_to_i(grid, x2, y2)];
+        memcpy(dest->ptr, cellxy->ptr, grid->cell_size);
+        dest->stamp = cellxy->stamp;
+        clear_cell(grid, cellxy);
+        cell_changed(grid, x1, y1);
+        cell_changed(grid, x2, y2);
+        return;
+    }
 
-    clear_cell(grid, cellxy);
+    if (x1 == x2 && y1 == y2) { return; }
+
+    // Hand the pointer over to (x2, y2) - no allocation or copy, only the overwritten data is freed
+    cell_t *dest = &grid->cells[pos_to_i(grid, x2, y2)];
+    clear_cell(grid, dest);
+    dest->ptr = cellxy->ptr;
+    dest->size = cellxy->size;
+    dest->stamp = cellxy->stamp; // The abstract cell keeps its stamp
+    cellxy->ptr = NULL;
+    cellxy->size = 0;
+    cell_changed(grid, x1, y1);
+    cell_changed(grid, x2, y2);
+}
+
+// Like 'ca_lib_insert_cell', but the cell takes over 'data_ptr' instead of copying it
+void ca_lib_insert_owned_cell(ca_lib_grid_t *grid, size_t x, size_t y, size_t data_size, void *data_ptr)
+{
+    if (!ca_lib_check_limits(grid, x, y) || grid->cell_size || data_size > UINT32_MAX) { return; }
+    // The pooled and interned free functions find a payload's owner through a header in front of it - anything else can't be freed
+    bool pooled = grid->pool && (ca_lib_pool_owns(grid->pool, data_ptr) || ca_lib_pool_owns(ca_lib_shared_pool(), data_ptr));
+    if (grid->pool && data_ptr && !pooled) { return; }
+    bool interned = grid->interns && ca_lib_intern_owns(grid->interns, data_ptr);
+    if (grid->interns && data_ptr && !interned) { return; }
+
+    cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+    mark_dirty(grid, x, y);
+    if (cell->ptr != data_ptr) { clear_cell(grid, cell); }
+    cell->ptr = data_ptr;
+    cell->size = data_ptr ? data_size : 0;
+    cell_changed(grid, x, y);
+}
+
+// Detach the cell's data without freeing it - the caller becomes its owner
+data_t ca_lib_take_cell(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+    data_t data = {x, y, 0, NULL};
+    if (!ca_lib_check_limits(grid, x, y) || grid->cell_size) { return data; }
+
+    cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+    mark_dirty(grid, x, y);
+    data = cell_data(cell, x, y);
+    cell->ptr = NULL;
+    cell->size = 0;
+    cell_changed(grid, x, y);
+    return data;
 }
 
 // Switches the cells' data at (x1,y1) and (x2, y2)
@@ -226,28 +1248,69 @@ void ca_lib_switch_cells(ca_lib_grid_t *grid, size_t x1, size_t y1, size_t x2, s
     }
     
     // No real memory management is needed, simply switch the 'data'
-    cell_t *cell_1 = &grid->cells[pos_to_i(grid->width, x1, y1)];
-    cell_t *cell_2 = &grid->cells[pos_to_i(grid->width, x2, y2)];
-    data_t data_1 = cell_1->data;
-    data_1.x = x2;
-    data_1.y = y2;
-    data_t data_2 = cell_2->data;
-    data_2.x = x1;
-    data_2.y = y1;
-    cell_1->data = data_2;
-    cell_2->data = data_1;
+    cell_t *cell_1 = &grid->cells[pos_to_i(grid, x1, y1)];
+    cell_t *cell_2 = &grid->cells[pos_to_i(grid, x2, y2)];
+    mark_dirty(grid, x1, y1);
+    mark_dirty(grid, x2, y2);
+
+    // The stamps follow the data
+    unsigned int stamp = cell_1->stamp;
+    cell_1->stamp = cell_2->stamp;
+    cell_2->stamp = stamp;
+
+    // Typed grids keep every payload in its own slot - switch the bytes instead
+    if (grid->cell_size)
+    {
+        if (cell_1 != cell_2) { swap_bytes(cell_1->ptr, cell_2->ptr, grid->cell_size); }
+        cell_changed(grid, x1, y1);
+        cell_changed(grid, x2, y2);
+        return;
+    }
+
+    void *ptr = cell_1->ptr;
+    uint32_t size = cell_1->size;
+    cell_1->ptr = cell_2->ptr;
+    cell_1->size = cell_2->size;
+    cell_2->ptr = ptr;
+    cell_2->size = size;
+    cell_changed(grid, x1, y1);
+    cell_changed(grid, x2, y2);
+}
+
+// Copy-on-write for interned payloads - the other cells sharing the old payload keep it
+void ca_lib_modify_cell(ca_lib_grid_t *grid, size_t x, size_t y, ca_lib_modify_data_t modify_func, void *arg)
+{
+    if (!ca_lib_check_limits(grid, x, y)) { return; }
+    cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+    if (!cell->ptr) { return; }
+    mark_dirty(grid, x, y);
+    if (!grid->interns)
+    {
+        modify_func(cell->ptr, cell->size, arg);
+        cell_changed(grid, x, y);
+        return;
+    }
+
+    void *copy = malloc(cell->size > 0 ? cell->size : 1);
+    memcpy(copy, cell->ptr, cell->size);
+    modify_func(copy, cell->size, arg);
+    void *shared = ca_lib_intern(grid->interns, copy, cell->size);
+    ca_lib_release_interned(cell->ptr);
+    cell->ptr = shared;
+    free(copy);
+    cell_changed(grid, x, y);
 }
 
 // Get the data_t 'data' from cell at (x,y) in grid
 data_t ca_lib_get_cell_data(ca_lib_grid_t *grid, size_t x, size_t y)
 {
-    return grid->cells[pos_to_i(grid->width, x, y)].data;
+    return cell_data(&grid->cells[pos_to_i(grid, x, y)], x, y);
 }
 
 // Check whether the cell at (x,y) in 'grid' is empty ('data_ptr' == NULL)
 bool ca_lib_cell_empty(ca_lib_grid_t *grid, size_t x, size_t y)
 {
-    return grid->cells[pos_to_i(grid->width, x, y)].data.ptr == NULL;
+    return grid->cells[pos_to_i(grid, x, y)].ptr == NULL;
 }
 
 // Prints a simple representation of the given 'grid'
@@ -258,35 +1321,440 @@ void ca_lib_print_grid(ca_lib_grid_t *grid, ca_lib_data_to_char_t convert_func)
     {
         for (int x = 0; x < (int)grid->width; x++)
         {
-            char c = convert_func(grid->cells[pos_to_i(grid->width, (size_t)x, (size_t)y)].data.ptr);
+            char c = convert_func(grid->cells[pos_to_i(grid, (size_t)x, (size_t)y)].ptr);
             x == 0 ? printf("\n%c", c) : printf("%c", c); // Print new line if x == 0
         }
     }
     puts(""); // new line
 }
 
+// Applies the given simulation function to each abstract cell exactly once
+// Cells are stamped with the current step when simulated, and since stamps move along with the data
+// a cell that has already been simulated is skipped if it is moved further ahead in the array
 void ca_lib_simulate(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func)
 {
-    ioopm_list_t *cell_buf = create_cell_buffer(grid);
-    while (!ioopm_linked_list_is_empty(cell_buf))
+    ca_lib_begin_generation(grid);
+    unsigned int step = next_step(grid);
+    for (size_t y = 0; y < grid->height; y++)
     {
-        data_t *current_data;
-        ioopm_linked_list_remove(cell_buf, 0, (void **)(&current_data));
-        sim_func(grid, current_data);
+        cell_t *row = &grid->cells[pos_to_i(grid, 0, y)];
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            if (row[x].stamp == step) { continue; } // Already simulated this step
+            row[x].stamp = step;
+            simulate_cell(grid, sim_func, &row[x], x, y);
+        }
     }
-    ioopm_linked_list_destroy(&cell_buf);
 }
 
 // Applies the given simulation function to the grid without keeping track of movement
 // It naïvely applies the sim_func on each cell - good for simple automatas where movement isn't implemented
 void ca_lib_simulate_unabstract(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func)
 {
-    for (size_t i = 0; i < grid->height * grid->width; i++)
+    ca_lib_begin_generation(grid);
+    for (size_t y = 0; y < grid->height; y++)
     {
-        sim_func(grid, &grid->cells[i].data);
+        cell_t *row = &grid->cells[pos_to_i(grid, 0, y)];
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            simulate_cell(grid, sim_func, &row[x], x, y);
+        }
+    }
+}
+
+// Splits the grid into horizontal bands, several per thread, and simulates the bands concurrently
+// Only safe for rules that write to nothing but their own cell, otherwise falls back to 'ca_lib_simulate_unabstract'
+void ca_lib_simulate_unabstract_parallel(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func)
+{
+    if (!grid->local_rule || band_count(grid, grid->height) <= 1)
+    {
+        ca_lib_simulate_unabstract(grid, sim_func);
+        return;
+    }
+
+    ca_lib_begin_generation(grid);
+    if (!grid->row_bands) { plan_row_bands(grid); }
+    for (size_t b = 0; b < grid->row_band_count; b++)
+    {
+        grid->row_bands[b].sim_func = sim_func;
+    }
+    run_jobs(grid, simulate_row_band, grid->row_bands, sizeof(row_band_t), grid->row_band_count);
+}
+
+// Tiles of the same phase are at least one tile apart - so as long as the rule's reach is less than half a tile
+// no cell can be touched by two workers at once. Stamps make sure cells moving between tiles are simulated only once
+void ca_lib_simulate_phased(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func)
+{
+    ca_lib_begin_generation(grid);
+    unsigned int step = next_step(grid);
+    if (!grid->phase_tiles) { plan_phase_tiles(grid); }
+    for (size_t t = 0; t < grid->phase_starts[4]; t++)
+    {
+        grid->phase_tiles[t].sim_func = sim_func;
+        grid->phase_tiles[t].step = step;
+    }
+    for (size_t phase = 0; phase < 4; phase++)
+    {
+        size_t job_count = grid->phase_starts[phase + 1] - grid->phase_starts[phase];
+        run_jobs(grid, simulate_tile_phase, &grid->phase_tiles[grid->phase_starts[phase]], sizeof(tile_phase_t), job_count); // Barrier between phases
+    }
+}
+
+// Only visits chunks that were changed since the previous active step began, and their neighbours
+// Cells are visited in the same order, and with the same exactly-once guarantee, as 'ca_lib_simulate'
+void ca_lib_simulate_active(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func)
+{
+    // A chunk is active if it or any of its neighbours is dirty - changes at a chunk's border affect the next chunk
+    for (size_t cy = 0; cy < grid->chunks_y; cy++)
+    {
+        for (size_t cx = 0; cx < grid->chunks_x; cx++)
+        {
+            bool active = false;
+            for (size_t ny = cy > 0 ? cy - 1 : 0; !active && ny <= cy + 1 && ny < grid->chunks_y; ny++)
+            {
+                for (size_t nx = cx > 0 ? cx - 1 : 0; !active && nx <= cx + 1 && nx < grid->chunks_x; nx++)
+                {
+                    active = atomic_load_explicit(&grid->dirty_chunks[nx + ny * grid->chunks_x], memory_order_relaxed);
+                }
+            }
+            grid->active_chunks[cx + cy * grid->chunks_x] = active;
+        }
+    }
+    // Changes made during this step decide what is active in the next
+    for (size_t c = 0; c < grid->chunks_x * grid->chunks_y; c++)
+    {
+        atomic_store_explicit(&grid->dirty_chunks[c], false, memory_order_relaxed);
+    }
+
+    ca_lib_begin_generation(grid);
+    unsigned int step = next_step(grid);
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        bool *active_row = &grid->active_chunks[(y / CA_LIB_CHUNK_SIZE) * grid->chunks_x];
+        for (size_t cx = 0; cx < grid->chunks_x; cx++)
+        {
+            if (!active_row[cx]) { continue; }
+            size_t x_end = (cx + 1) * CA_LIB_CHUNK_SIZE < grid->width ? (cx + 1) * CA_LIB_CHUNK_SIZE : grid->width;
+            for (size_t x = cx * CA_LIB_CHUNK_SIZE; x < x_end; x++)
+            {
+                cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+                if (cell->stamp == step) { continue; } // Already simulated this step
+                cell->stamp = step;
+                simulate_cell(grid, sim_func, cell, x, y);
+            }
+        }
     }
 }
 
+void ca_lib_simulate_neighbourhood(ca_lib_grid_t *grid, ca_lib_neighbourhood_kind_t kind, int radius, ca_lib_simulate_neighbourhood_t sim_func)
+{
+    if (radius < 0) { return; }
+    ca_lib_neighbourhood_t neighbourhood;
+    neighbourhood.radius = radius;
+    neighbourhood.side = 2 * radius + 1;
+    neighbourhood.ptrs = reserve_neighbourhoods(grid, neighbourhood.side);
+
+    ca_lib_begin_generation(grid);
+    unsigned int step = next_step(grid);
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            cell_t *cell = &grid->cells[pos_to_i(grid, x, y)];
+            if (cell->stamp == step) { continue; } // Already simulated this step
+            cell->stamp = step;
+            gather_neighbourhood(grid, kind, x, y, &neighbourhood);
+            data_t data = cell_data(cell, x, y);
+            void *ptr = data.ptr;
+            size_t size = data.size;
+            sim_func(grid, &data, &neighbourhood);
+            keep_assigned_data(grid, cell, &data, ptr, size);
+        }
+    }
+}
+
+// Rows are handed over whole so the rule can run a tight loop over them, bands of rows run concurrently
+void ca_lib_simulate_rows(ca_lib_grid_t *grid, ca_lib_simulate_row_t row_func)
+{
+    if (grid->cell_size == 0 || grid->height == 0) { return; }
+    ca_lib_begin_generation(grid);
+    size_t row_bytes = grid->width * grid->cell_size;
+
+    if (!grid->row_span_bands) { plan_row_span_bands(grid); }
+    for (size_t b = 0; b < grid->row_span_band_count; b++)
+    {
+        row_span_band_t *band = &grid->row_span_bands[b];
+        band->row_func = row_func;
+        if (band->y_start > 0) { memcpy(band->edges, grid->payloads + (band->y_start - 1) * row_bytes, row_bytes); }
+        if (band->y_end < grid->height) { memcpy(band->edges + row_bytes, grid->payloads + band->y_end * row_bytes, row_bytes); }
+    }
+    run_jobs(grid, simulate_row_span_band, grid->row_span_bands, sizeof(row_span_band_t), grid->row_span_band_count);
+}
+
+// Writes only go to the back buffer, so the neighbourhoods gathered from the grid are the previous generation throughout
+static void simulate_sync_band(void *job)
+{
+    sync_band_t *band = job;
+    ca_lib_grid_t *grid = band->grid;
+    ca_lib_neighbourhood_t neighbourhood = band->neighbourhood;
+    neighbourhood.ptrs += current_worker(grid) * neighbourhood.side * neighbourhood.side;
+    for (size_t y = band->y_start; y < band->y_end; y++)
+    {
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            size_t offset = (x + y * grid->width) * grid->cell_size;
+            memcpy(grid->back + offset, grid->payloads + offset, grid->cell_size); // Cells the rule leaves alone keep their payload
+            gather_neighbourhood(grid, band->kind, x, y, &neighbourhood);
+            data_t data = {x, y, grid->cell_size, grid->back + offset};
+            band->sim_func(grid, &data, &neighbourhood);
+        }
+    }
+}
+
+// The rule only reads the grid, so the cells can be visited in any order
+static void gather_intents(void *job)
+{
+    intent_band_t *band = job;
+    ca_lib_grid_t *grid = band->grid;
+    for (size_t y = band->y_start; y < band->y_end; y++)
+    {
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            ca_lib_intent_t *intent = &grid->intents[x + y * grid->width];
+            *intent = (ca_lib_intent_t){0, 0, 0};
+            data_t data = cell_data(&grid->cells[pos_to_i(grid, x, y)], x, y);
+            band->intent_func(grid, &data, intent);
+            bool inside = intent->dx >= -1 && intent->dx <= 1 && intent->dy >= -1 && intent->dy <= 1 &&
+                          ca_lib_check_limits(grid, x + intent->dx, y + intent->dy);
+            if (!inside) { *intent = (ca_lib_intent_t){0, 0, 0}; } // Nowhere to go
+        }
+    }
+}
+
+// Whether the move out of cell 'a' beats the move out of cell 'b' - both by index
+static bool intent_beats(ca_lib_grid_t *grid, size_t a, size_t b)
+{
+    if (grid->intents[a].priority != grid->intents[b].priority) { return grid->intents[a].priority > grid->intents[b].priority; }
+    uint64_t hash_a = ca_lib_random(grid, a % grid->width, a / grid->width, INTENT_TIE_STREAM);
+    uint64_t hash_b = ca_lib_random(grid, b % grid->width, b / grid->width, INTENT_TIE_STREAM);
+    if (hash_a != hash_b) { return hash_a > hash_b; }
+    return a < b;
+}
+
+// Every cell picks the best of the neighbours that want to move into it
+static void resolve_intents(void *job)
+{
+    intent_band_t *band = job;
+    ca_lib_grid_t *grid = band->grid;
+    for (size_t y = band->y_start; y < band->y_end; y++)
+    {
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            size_t winner = CA_LIB_NO_WINNER;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    if ((dx == 0 && dy == 0) || !ca_lib_check_limits(grid, x + dx, y + dy)) { continue; }
+                    size_t source = (x + dx) + (y + dy) * grid->width;
+                    if (grid->intents[source].dx != -dx || grid->intents[source].dy != -dy) { continue; }
+                    if (winner == CA_LIB_NO_WINNER || intent_beats(grid, source, winner)) { winner = source; }
+                }
+            }
+            grid->winners[x + y * grid->width] = winner;
+        }
+    }
+}
+
+// Whether the cell at index 'i' was picked by the destination of its intent
+static bool wins_move(ca_lib_grid_t *grid, size_t i)
+{
+    const ca_lib_intent_t *intent = &grid->intents[i];
+    if (intent->dx == 0 && intent->dy == 0) { return false; }
+    size_t destination = (i % grid->width + intent->dx) + (i / grid->width + intent->dy) * grid->width;
+    return grid->winners[destination] == i;
+}
+
+// A swap touches its source and destination only. A destination whose occupant wins its own move is left to it, and
+// the source waits - so no two accepted swaps share a cell, and an occupant is never pulled back against its move
+static void commit_intents(void *job)
+{
+    intent_band_t *band = job;
+    ca_lib_grid_t *grid = band->grid;
+    for (size_t y = band->y_start; y < band->y_end; y++)
+    {
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            size_t source = x + y * grid->width;
+            if (!wins_move(grid, source)) { continue; }
+            ca_lib_intent_t *intent = &grid->intents[source];
+            size_t destination = (x + intent->dx) + (y + intent->dy) * grid->width;
+            if (wins_move(grid, destination)) { continue; }
+            ca_lib_switch_cells(grid, x, y, x + intent->dx, y + intent->dy);
+        }
+    }
+}
+
+// Typed grids keep every payload in its own slot - an entry now pointing at another entry's slot gets a copy of
+// that slot's bytes as they were handed over. Payloads written in place are found by comparing against those too.
+static void keep_typed_block(ca_lib_grid_t *grid, const data_t *block, cell_t **cells, const unsigned char *saved)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            if (j != i && block[i].ptr == cells[j]->ptr) { memcpy(cells[i]->ptr, saved + j * grid->cell_size, grid->cell_size); }
+        }
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        if (memcmp(cells[i]->ptr, saved + i * grid->cell_size, grid->cell_size) == 0) { continue; }
+        mark_dirty(grid, block[i].x, block[i].y);
+        cell_changed(grid, block[i].x, block[i].y);
+    }
+}
+
+static void simulate_block_band(void *job)
+{
+    block_band_t *band = job;
+    ca_lib_grid_t *grid = band->grid;
+    unsigned char *saved = band->saved + current_worker(grid) * 4 * grid->cell_size;
+    for (size_t row = band->row_start; row < band->row_end; row++)
+    {
+        size_t y = band->offset + 2 * row;
+        if (y + 1 >= grid->height) { break; } // The last row of blocks of an odd step on an even height
+        for (size_t x = band->offset; x + 1 < grid->width; x += 2)
+        {
+            cell_t *cells[4];
+            data_t block[4];
+            void *ptrs[4];
+            size_t sizes[4];
+            for (int i = 0; i < 4; i++)
+            {
+                cells[i] = &grid->cells[pos_to_i(grid, x + i % 2, y + i / 2)];
+                block[i] = cell_data(cells[i], x + i % 2, y + i / 2);
+                ptrs[i] = block[i].ptr;
+                sizes[i] = block[i].size;
+                if (grid->cell_size) { memcpy(saved + i * grid->cell_size, ptrs[i], grid->cell_size); }
+            }
+            band->block_func(grid, block);
+            for (int i = 0; i < 4; i++)
+            {
+                block[i].x = x + i % 2; // Read-Only - the rule may have exchanged whole entries
+                block[i].y = y + i / 2;
+            }
+            if (grid->cell_size)
+            {
+                keep_typed_block(grid, block, cells, saved);
+                continue;
+            }
+            for (int i = 0; i < 4; i++)
+            {
+                keep_assigned_data(grid, cells[i], &block[i], ptrs[i], sizes[i]);
+            }
+        }
+    }
+}
+
+// Every tile reads the generation the call started from, so the tiles of a tile row are independent. Tile rows are
+// computed in order, and each is copied back as soon as the last tile row whose margins reach into it is done - so only
+// a few tile rows of results are held at a time, and they are copied back while still in cache
+void ca_lib_simulate_rows_blocked(ca_lib_grid_t *grid, ca_lib_simulate_row_t row_func, size_t steps)
+{
+    if (grid->cell_size == 0 || grid->height == 0 || steps == 0) { return; }
+    ca_lib_begin_generation(grid);
+    grid->generation += steps - 1; // The generations in between only ever exist inside the tiles
+    size_t tiles_x = (grid->width + grid->tile_size - 1) / grid->tile_size;
+    size_t tiles_y = (grid->height + grid->tile_size - 1) / grid->tile_size;
+    size_t reach = (steps + grid->tile_size - 1) / grid->tile_size; // Tile rows above and below that a margin reaches into
+    size_t slots = reach + 2 < tiles_y ? reach + 2 : tiles_y; // Tile rows computed but not yet copied back
+    size_t slot_bytes = grid->tile_size * grid->width * grid->cell_size;
+    size_t plane_bytes = (grid->tile_size + 2 * steps) * (grid->tile_size + 2 * steps) * grid->cell_size;
+    reserve_buffer(&grid->blocked_rows, &grid->blocked_rows_bytes, slots * slot_bytes);
+    reserve_buffer(&grid->blocked_planes, &grid->blocked_planes_bytes, grid->thread_count * 2 * plane_bytes);
+
+    blocked_tile_t *jobs = calloc((slots + 1) * tiles_x, sizeof(blocked_tile_t));
+    size_t written = 0; // Tile rows before this one are copied back
+    for (size_t ty = 0; ty <= tiles_y; ty++)
+    {
+        size_t job_count = 0;
+        for (size_t tx = 0; ty < tiles_y && tx < tiles_x; tx++)
+        {
+            unsigned char *rows = grid->blocked_rows + (ty % slots) * slot_bytes;
+            jobs[job_count++] = (blocked_tile_t){grid, row_func, steps, rows, grid->blocked_planes, plane_bytes, tx, ty, false};
+        }
+        // A tile row more than 'reach' rows up is read by neither this tile row nor any after it - the last round copies back the rest
+        for (; written < tiles_y && (ty == tiles_y || written + reach < ty); written++)
+        {
+            for (size_t tx = 0; tx < tiles_x; tx++)
+            {
+                unsigned char *rows = grid->blocked_rows + (written % slots) * slot_bytes;
+                jobs[job_count++] = (blocked_tile_t){grid, row_func, steps, rows, grid->blocked_planes, plane_bytes, tx, written, true};
+            }
+        }
+        run_jobs(grid, run_blocked_tile, jobs, sizeof(blocked_tile_t), job_count); // Barrier before the next tile row
+    }
+    free(jobs);
+}
+
+// The cells point at 'payloads' for good, so rather than swapping buffers the back buffer is copied over - the same
+// pass finds the changed cells, which a swap would have to do anyway
+void ca_lib_simulate_sync(ca_lib_grid_t *grid, ca_lib_neighbourhood_kind_t kind, int radius, ca_lib_simulate_neighbourhood_t sim_func)
+{
+    if (!grid->back || radius < 0 || grid->height == 0) { return; }
+    ca_lib_begin_generation(grid);
+    size_t side = 2 * radius + 1;
+    size_t row_bytes = grid->width * grid->cell_size;
+
+    void **ptrs = reserve_neighbourhoods(grid, side);
+    for (size_t b = 0; b < grid->sync_band_count; b++)
+    {
+        sync_band_t *band = &grid->sync_bands[b];
+        band->sim_func = sim_func;
+        band->kind = kind;
+        band->neighbourhood = (ca_lib_neighbourhood_t){radius, side, ptrs};
+    }
+    run_jobs(grid, simulate_sync_band, grid->sync_bands, sizeof(sync_band_t), grid->sync_band_count);
+
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        mark_changed_span(grid, y, 0, grid->width, grid->payloads + y * row_bytes, grid->back + y * row_bytes);
+        memcpy(grid->payloads + y * row_bytes, grid->back + y * row_bytes, row_bytes);
+    }
+}
+
+void ca_lib_simulate_intents(ca_lib_grid_t *grid, ca_lib_simulate_intent_t intent_func)
+{
+    if (grid->height == 0) { return; }
+    ca_lib_begin_generation(grid);
+    if (!grid->intents)
+    {
+        grid->intents = malloc(grid->width * grid->height * sizeof(ca_lib_intent_t));
+        grid->winners = malloc(grid->width * grid->height * sizeof(size_t));
+    }
+    if (!grid->intent_bands) { plan_intent_bands(grid); }
+    for (size_t b = 0; b < grid->intent_band_count; b++) { grid->intent_bands[b].intent_func = intent_func; }
+    // Each phase needs the previous one finished everywhere - 'run_jobs' returning is the barrier
+    run_jobs(grid, gather_intents, grid->intent_bands, sizeof(intent_band_t), grid->intent_band_count);
+    run_jobs(grid, resolve_intents, grid->intent_bands, sizeof(intent_band_t), grid->intent_band_count);
+    run_jobs(grid, commit_intents, grid->intent_bands, sizeof(intent_band_t), grid->intent_band_count);
+}
+
+// The blocks of a step are disjoint, so they need no ordering between them at all
+void ca_lib_simulate_margolus(ca_lib_grid_t *grid, ca_lib_simulate_block_t block_func)
+{
+    size_t offset = grid->generation % 2;
+    ca_lib_begin_generation(grid);
+    if (grid->height < offset + 2) { return; } // Not a single row of blocks
+    if (!grid->block_bands) { plan_block_bands(grid); }
+    for (size_t b = 0; b < grid->block_band_count; b++)
+    {
+        grid->block_bands[b].block_func = block_func;
+        grid->block_bands[b].offset = offset;
+    }
+    run_jobs(grid, simulate_block_band, grid->block_bands, sizeof(block_band_t), grid->block_band_count);
+}
+
 /// GRAPHICS ///
 
 // draw an size x size cube
@@ -317,9 +1785,13 @@ static void render_cell(ca_lib_grid_t *grid, data_t *data, ca_lib_cell_to_color_
 
 static void render_grid(ca_lib_grid_t *grid, ca_lib_cell_to_color_t color_convert_func, size_t scale)
 {
-    for (size_t i = 0; i < grid->height * grid->width; i++)
+    for (size_t y = 0; y < grid->height; y++)
     {
-        render_cell(grid, &grid->cells[i].data, color_convert_func, scale);
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            data_t data = cell_data(&grid->cells[pos_to_i(grid, x, y)], x, y);
+            render_cell(grid, &data, color_convert_func, scale);
+        }
     }
 }
 
@@ -1,20 +1,64 @@
 #pragma once
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // ca-lib user-reachable datatypes
 
+// Default side of the tiles used by 'ca_lib_simulate_phased'
+#define CA_LIB_DEFAULT_TILE_SIZE 32
+
+// Side of the square chunks whose activity is tracked for 'ca_lib_simulate_active'
+#define CA_LIB_CHUNK_SIZE 64
+
+// The view of a cell handed to the rules - 'size' and 'ptr' may be reassigned, and are stored back into the cell
 struct data
 {
     size_t x; // Read-Only
     size_t y; // Read-Only
-    size_t size;
+    size_t size; // At most UINT32_MAX
     void *ptr; 
 };
 typedef struct data data_t;
 
 typedef struct grid ca_lib_grid_t;
 
+/// @brief Shape of the neighbourhood gathered by 'ca_lib_simulate_neighbourhood'
+enum neighbourhood_kind
+{
+    CA_LIB_MOORE, // Every cell within 'radius' steps in x and y
+    CA_LIB_VON_NEUMANN // Every cell within a manhattan distance of 'radius'
+};
+typedef enum neighbourhood_kind ca_lib_neighbourhood_kind_t;
+
+/// @brief Read-only view of the cells around the simulated cell - see 'ca_lib_neighbour'
+struct neighbourhood
+{
+    int radius; // Read-Only
+    int side; // Read-Only - 2 * 'radius' + 1
+    void **ptrs; // Read-Only - 'side' * 'side' 'data.ptr' pointers, row by row starting at (-radius, -radius)
+};
+typedef struct neighbourhood ca_lib_neighbourhood_t;
+
+/// @brief What lies beyond the edges of a grid - see 'ca_lib_set_boundary'
+enum boundary
+{
+    CA_LIB_BOUNDARY_NONE, // Empty cells (default)
+    CA_LIB_BOUNDARY_PERIODIC, // The opposite edge - the grid is a torus
+    CA_LIB_BOUNDARY_REFLECTIVE, // The grid mirrored in its edges
+    CA_LIB_BOUNDARY_CONSTANT // One fixed payload
+};
+typedef enum boundary ca_lib_boundary_t;
+
+/// @brief Where a cell wants to move in 'ca_lib_simulate_intents' - starts out as (0,0), staying put
+struct intent
+{
+    int dx; // -1, 0 or 1
+    int dy; // -1, 0 or 1
+    unsigned int priority; // Decides between cells that want the same destination - highest wins
+};
+typedef struct intent ca_lib_intent_t;
+
 /// @brief Allocates a space 'data_size' large and copies over the data from 'data_ptr' - returns the allocated pointer
 typedef void *(*ca_lib_data_alloc_function_t)(void *data_ptr, size_t data_size);
 /// @brief Frees the data stored in 'data_ptr' and returns null 
@@ -24,13 +68,48 @@ typedef void *(*ca_lib_data_free_function_t)(void *data_ptr);
 typedef char(*ca_lib_data_to_char_t)(void *data_ptr);
 
 /// @brief Provided the data of a cell - implement desired simulation
+/// 'data' is built for the call from the cell's position - assigning 'data->ptr' or 'data->size' stores them in the cell
 typedef void(*ca_lib_simulate_cell_t)(ca_lib_grid_t *grid, data_t *data);
 
+/// @brief One of the jobs handed to 'ca_lib_run_jobs'
+typedef void(*ca_lib_job_t)(void *job);
+
 /// @brief Provided a grid - simulate it
 typedef void(*ca_lib_simulate_grid_t)(ca_lib_grid_t *grid);
 
 typedef void(*ca_lib_cell_to_color_t)(data_t *data, int *color);
 
+/// @brief Changes the 'data_size' bytes of a payload in place, 'arg' is passed through from 'ca_lib_modify_cell'
+typedef void(*ca_lib_modify_data_t)(void *data_ptr, size_t data_size, void *arg);
+
+/// @brief Sorts a payload into one of the classes counted by 'ca_lib_set_classifier' - must only depend on the payload's bytes
+typedef size_t(*ca_lib_classify_data_t)(void *data_ptr, size_t data_size);
+
+/// @brief Provided the data of a cell - fill in 'intent' with where it wants to move, reading the grid but not changing it
+typedef void(*ca_lib_simulate_intent_t)(ca_lib_grid_t *grid, const data_t *data, ca_lib_intent_t *intent);
+
+/// @brief Provided a 2x2 block of cells - (x,y), (x+1,y), (x,y+1), (x+1,y+1) in that order - permute or rewrite it
+/// Entries are permuted by exchanging their 'ptr' and 'size' - 'x' and 'y' stay with the position
+typedef void(*ca_lib_simulate_block_t)(ca_lib_grid_t *grid, data_t block[4]);
+
+/// @brief Provided the data of a cell and its gathered neighbourhood - implement desired simulation
+typedef void(*ca_lib_simulate_neighbourhood_t)(ca_lib_grid_t *grid, data_t *data, const ca_lib_neighbourhood_t *neighbourhood);
+
+/// @brief Provided a row of a typed grid and the rows around it - write the next generation of the row into 'out'
+/// Every row holds 'width' payloads of the grid's 'cell_size' bytes. 'above', 'row' and 'below' are copies of the
+/// previous generation, 'above' is NULL on the first row and 'below' on the last. 'out' is the row in the grid itself.
+typedef void(*ca_lib_simulate_row_t)(ca_lib_grid_t *grid, size_t y, size_t width, const void *above, const void *row, const void *below, void *out);
+
+/// @brief The 'data.ptr' of the cell at offset (dx, dy) from the simulated cell
+/// @param neighbourhood the neighbourhood handed to the rule
+/// @param dx -radius to radius
+/// @param dy -radius to radius
+/// @return the cell's 'data.ptr' - NULL if the cell is empty, outside of the neighbourhood's shape or outside of a grid without boundary
+static inline void *ca_lib_neighbour(const ca_lib_neighbourhood_t *neighbourhood, int dx, int dy)
+{
+    return neighbourhood->ptrs[(dy + neighbourhood->radius) * neighbourhood->side + dx + neighbourhood->radius];
+}
+
 /*----FUNCTION HEADERS----*/
 
 /// @brief Allocate a new pointer on the heap with size data.size, copy over 'data_ptr'
@@ -44,6 +123,47 @@ void *ca_lib_alloc_simple_ptr (void *data_ptr, size_t data_size);
 /// @return null
 void *ca_lib_free_simple_ptr (void *data_ptr);
 
+/// @brief Allocate 'data_size' bytes from a size-class slab pool, copy over 'data_ptr'
+/// A grid created with the pooled pair gets a pool of its own, which reuses freed payloads in O(1) and is released
+/// all at once by 'ca_lib_destroy_grid'. Rules that assign 'data->ptr' themselves on such a grid must allocate it with this function.
+/// @param data_ptr the data_ptr that will be copied into the pool
+/// @param data_size size of 'data_ptr' in bytes
+/// @return the allocated pointer
+void *ca_lib_alloc_pooled_ptr (void *data_ptr, size_t data_size);
+
+/// @brief Returns the given pointer to the pool it was allocated from
+/// @param data_ptr a pointer from 'ca_lib_alloc_pooled_ptr'
+/// @return null
+void *ca_lib_free_pooled_ptr (void *data_ptr);
+
+/// @brief Return the one shared, immutable allocation holding the same bytes as 'data_ptr'
+/// Grids created with the interned pair use the same table, so cells with equal payloads share a pointer and can be
+/// compared by it - whether they were inserted or allocated by a rule. Payloads may not be written through 'data.ptr' - use 'ca_lib_modify_cell', which copies on write.
+/// @param data_ptr the data_ptr whose bytes are looked up
+/// @param data_size size of 'data_ptr' in bytes
+/// @return the shared pointer
+void *ca_lib_alloc_interned_ptr (void *data_ptr, size_t data_size);
+
+/// @brief Drops a reference to the given shared pointer, freeing it once no cell uses it
+/// @param data_ptr a pointer from 'ca_lib_alloc_interned_ptr'
+/// @return null
+void *ca_lib_free_interned_ptr (void *data_ptr);
+
+/// @brief Allocate 'data_size' bytes from a bump allocated arena, copy over 'data_ptr'
+/// A grid created with the arena pair gets an arena of its own for the payloads it allocates ('ca_lib_insert_cell') - they are
+/// never freed one by one, but all at once by 'ca_lib_reset_grid' and 'ca_lib_destroy_grid'. Meant for short-lived grids, as
+/// overwritten payloads take up space until then. Calling this function directly, as a rule assigning 'data.ptr' does,
+/// allocates from a process-wide arena instead, which is never rewound and only grows - rules should insert instead.
+/// @param data_ptr the data_ptr that will be copied into the arena
+/// @param data_size size of 'data_ptr' in bytes
+/// @return the allocated pointer
+void *ca_lib_alloc_arena_ptr (void *data_ptr, size_t data_size);
+
+/// @brief Does nothing - arena payloads are released along with the whole arena
+/// @param data_ptr a pointer from 'ca_lib_alloc_arena_ptr'
+/// @return null
+void *ca_lib_free_arena_ptr (void *data_ptr);
+
 /// @brief Creates a 'width' by 'height' grid
 /// @param width 
 /// @param heigth 
@@ -52,12 +172,137 @@ void *ca_lib_free_simple_ptr (void *data_ptr);
 /// @return a pointer to the allocated grid
 ca_lib_grid_t *ca_lib_create_grid(void *meta_data, size_t width, size_t heigth, ca_lib_data_alloc_function_t alloc_func, ca_lib_data_free_function_t free_func);
 
+/// @brief Creates a 'width' by 'height' grid where every cell stores a fixed-size payload inline in the grid allocation
+/// No per-cell heap allocation is done - cells are never empty, they start zeroed and 'data.ptr' always points at the cell's own slot.
+/// Inserting copies at most 'cell_size' bytes, clearing zeroes the slot, moving/switching copies/swaps the bytes.
+/// @param meta_data data pertaining to the whole grid
+/// @param width 
+/// @param height 
+/// @param cell_size size in bytes of every cell's payload
+/// @return a pointer to the allocated grid, NULL if 'cell_size' is larger than UINT32_MAX
+ca_lib_grid_t *ca_lib_create_typed_grid(void *meta_data, size_t width, size_t height, size_t cell_size);
+
 void *ca_lib_get_meta_data(ca_lib_grid_t *grid);
 
 size_t ca_lib_get_grid_width(ca_lib_grid_t *grid);
 
 size_t ca_lib_get_grid_height(ca_lib_grid_t *grid);
 
+/// @brief Sets how many worker threads the parallel simulation functions may use (default 1)
+/// @param grid 
+/// @param thread_count 
+void ca_lib_set_thread_count(ca_lib_grid_t *grid, size_t thread_count);
+
+/// @brief Pins the grid's worker threads to one CPU each (default off) - ignored where the platform doesn't support it
+/// The thread calling a simulation function is one of the workers, pinned only while the step runs and restored after
+/// @param grid 
+/// @param pin 
+void ca_lib_set_thread_affinity(ca_lib_grid_t *grid, bool pin);
+
+/// @brief Runs 'job_func' on all 'job_count' jobs (each 'job_size' bytes large, stored in 'jobs') on the grid's threads and returns when all are done
+/// The threads are started once and kept with the grid, so submitting jobs every step is cheap. Each thread starts out with
+/// a contiguous run of jobs and steals from the others once it runs out - split the work into more jobs than threads to even
+/// out uneven jobs. Jobs submitted from inside a job run on the calling thread alone.
+/// @param grid 
+/// @param job_func 
+/// @param jobs 
+/// @param job_size 
+/// @param job_count 
+void ca_lib_run_jobs(ca_lib_grid_t *grid, ca_lib_job_t job_func, void *jobs, size_t job_size, size_t job_count);
+
+/// @brief Declares whether the rule used on 'grid' only writes to the cell being simulated (default false)
+/// Parallel simulation of a rule that reads neighbours is only valid if it is declared local-write-only
+/// @param grid 
+/// @param local_rule true if the rule never modifies, moves or switches any other cell than its own
+void ca_lib_set_local_rule(ca_lib_grid_t *grid, bool local_rule);
+
+/// @brief Sets the side of the square tiles 'ca_lib_simulate_phased' splits the grid into (default 'CA_LIB_DEFAULT_TILE_SIZE')
+/// The rule may not read or write cells further away than (tile_size - 1) / 2 from the simulated cell
+/// @param grid 
+/// @param tile_size 
+void ca_lib_set_tile_size(ca_lib_grid_t *grid, size_t tile_size);
+
+/// @brief Gives a typed grid a back buffer for 'ca_lib_simulate_sync' to write the next generation into - allocated once, freed with the grid
+/// The cells keep pointing at their own slots, so the back buffer is copied over the payloads at the end of each step rather
+/// than swapped with them. Does nothing on grids not created by 'ca_lib_create_typed_grid'.
+/// @param grid 
+void ca_lib_enable_double_buffer(ca_lib_grid_t *grid);
+
+/// @brief Sets what the grid's halo - the ring of read-only cells just outside of it - holds
+/// Reading one cell beyond an edge with 'ca_lib_get_cell_data', e.g. at x = -1 or x = width, returns the halo cell,
+/// so rules can read their neighbours without checking limits. The halo is kept up to date as cells change,
+/// and refreshed by the engines at the start of every step. Writes outside of the grid are still ignored.
+/// The parallel engines assume the rule's reach is local - rules reading across a periodic edge must run on one thread.
+/// @param grid 
+/// @param boundary 
+/// @param data_size 'CA_LIB_BOUNDARY_CONSTANT': size of 'data_ptr' in bytes, otherwise ignored
+/// @param data_ptr 'CA_LIB_BOUNDARY_CONSTANT': the payload copied into the halo, otherwise ignored
+void ca_lib_set_boundary(ca_lib_grid_t *grid, ca_lib_boundary_t boundary, size_t data_size, void *data_ptr);
+
+/// @brief Sets the seed of 'ca_lib_random' (default 0)
+/// @param grid 
+/// @param seed 
+void ca_lib_set_seed(ca_lib_grid_t *grid, uint64_t seed);
+
+/// @brief Number of steps the grid has been simulated, by any engine
+/// @param grid 
+/// @return the generation
+uint64_t ca_lib_get_generation(ca_lib_grid_t *grid);
+
+/// @brief Keeps a 64-bit hash of the whole grid up to date as cells change, and remembers the hash each of the last 'window' generations
+/// started from - payloads written in place must be reported with 'ca_lib_mark_cell_dirty' for the hash to see them
+/// @param grid 
+/// @param window number of past generations searched by 'ca_lib_get_cycle_period' - 0 turns hashing off again
+void ca_lib_enable_state_hash(ca_lib_grid_t *grid, size_t window);
+
+/// @brief The hash of every cell's position and payload bytes - equal grids hash equal, different ones almost certainly don't
+/// @param grid a grid with 'ca_lib_enable_state_hash'
+/// @return the hash
+uint64_t ca_lib_get_state_hash(ca_lib_grid_t *grid);
+
+/// @brief Checks whether the grid is back in a state one of the remembered generations started from
+/// @param grid a grid with 'ca_lib_enable_state_hash'
+/// @return the number of generations since that state - 1 for a steady state - or 0 if there is no such state
+size_t ca_lib_get_cycle_period(ca_lib_grid_t *grid);
+
+/// @brief Simulates the grid until it settles into a steady state or cycle, or 'max_steps' steps have been taken
+/// @param grid a grid with 'ca_lib_enable_state_hash' - otherwise nothing is simulated
+/// @param sim_func simulates the grid one step, using any engine
+/// @param max_steps 
+/// @return the number of steps taken - 'ca_lib_get_cycle_period' tells whether it settled
+size_t ca_lib_run_until_stable(ca_lib_grid_t *grid, ca_lib_simulate_grid_t sim_func, size_t max_steps);
+
+/// @brief Counts the cells of every class, keeping the counts up to date as cells change - like the state hash,
+/// payloads written in place must be reported with 'ca_lib_mark_cell_dirty'
+/// @param grid 
+/// @param class_count number of classes - 'classify_func' results outside of [0, 'class_count') aren't counted
+/// @param classify_func called on every non-empty cell now, and again whenever it changes - NULL stops counting
+void ca_lib_set_classifier(ca_lib_grid_t *grid, size_t class_count, ca_lib_classify_data_t classify_func);
+
+/// @brief Number of cells currently in 'class' - O(1)
+/// @param grid a grid with 'ca_lib_set_classifier'
+/// @param class 
+/// @return the count - 0 for classes the grid doesn't count
+size_t ca_lib_get_population(ca_lib_grid_t *grid, size_t class);
+
+/// @brief A random number for the cell at (x,y) in the current generation - use instead of rand() in rules
+/// The number is a hash of (seed, generation, x, y, stream), so runs are reproducible whatever the thread count or
+/// engine, and threads share no state. The same key always gives the same number - draw several numbers for one cell
+/// in the same step by using different streams.
+/// @param grid 
+/// @param x 
+/// @param y 
+/// @param stream tells several draws for the same cell and step apart
+/// @return 64 random bits
+uint64_t ca_lib_random(ca_lib_grid_t *grid, size_t x, size_t y, uint64_t stream);
+
+/// @brief Flags the chunk containing (x,y) as changed so that 'ca_lib_simulate_active' visits it next step
+/// Insert/move/switch/clear do this automatically - only needed when a rule changes the contents of 'data.ptr' itself
+/// @param grid 
+/// @param x 
+/// @param y 
+void ca_lib_mark_cell_dirty(ca_lib_grid_t *grid, size_t x, size_t y);
+
 bool ca_lib_check_limits(ca_lib_grid_t *grid, size_t x, size_t y);
 
 /// @brief Frees the given grid and its cells' 'data_ptr' pointer and returns NULL
@@ -65,6 +310,11 @@ bool ca_lib_check_limits(ca_lib_grid_t *grid, size_t x, size_t y);
 /// @return NULL
 ca_lib_grid_t *ca_lib_destroy_grid(ca_lib_grid_t *grid);
 
+/// @brief Empties every cell, as if the grid was just created - settings such as the boundary are kept
+/// Arena grids release all payloads in one go and keep the arena's memory for reuse.
+/// @param grid the given grid to be reset
+void ca_lib_reset_grid(ca_lib_grid_t *grid);
+
 /// @brief Empty cell at (x,y), freeing it's data
 /// @param grid The grid to be operated on
 /// @param x 
@@ -75,11 +325,12 @@ void ca_lib_clear_cell(ca_lib_grid_t *grid, size_t x, size_t y);
 /// @param grid The given grid which the cell is to be inserted into
 /// @param x 
 /// @param y 
-/// @param data_size The total size of 'data_ptr' in bytes
+/// @param data_size The total size of 'data_ptr' in bytes - larger than UINT32_MAX is ignored
 /// @param data_ptr a pointer to the data_ptr one wishes to store in the cell
 void ca_lib_insert_cell(ca_lib_grid_t *grid, size_t x, size_t y, size_t data_size, void *data_ptr);
 
 /// @brief Moves the cell at (x1,y1) to (x2, y2) - overwriting and freeing any potential cell at (x2, y2)
+/// The pointer itself is handed over, so 'data.ptr' of the moved cell stays the same
 /// @param grid The given grid to be operated on
 /// @param x1 Cell to be moved
 /// @param y1 Cell to be moved
@@ -87,6 +338,25 @@ void ca_lib_insert_cell(ca_lib_grid_t *grid, size_t x, size_t y, size_t data_siz
 /// @param y2 Destination
 void ca_lib_move_cell(ca_lib_grid_t *grid, size_t x1, size_t y1, size_t x2, size_t y2);
 
+/// @brief Inserts 'data_ptr' itself into the cell at (x,y) - the grid takes ownership of it instead of copying it
+/// 'data_ptr' must be freeable by the grid's 'free_func'. Does nothing on typed grids, whose payloads live inline,
+/// or - leaving 'data_ptr' with the caller - if the grid uses the pooled or interned pair and 'data_ptr' isn't from its alloc function.
+/// @param grid The given grid which the cell is to be inserted into
+/// @param x 
+/// @param y 
+/// @param data_size The total size of 'data_ptr' in bytes - larger than UINT32_MAX is ignored
+/// @param data_ptr the pointer handed over to the grid
+void ca_lib_insert_owned_cell(ca_lib_grid_t *grid, size_t x, size_t y, size_t data_size, void *data_ptr);
+
+/// @brief Empties the cell at (x,y) without freeing its data, which is handed over to the caller
+/// The caller is responsible for freeing 'data.ptr' with the grid's 'free_func' - or inserting it again with 'ca_lib_insert_owned_cell'.
+/// Arena payloads stay valid until the grid is reset or destroyed. Typed grids, whose payloads live inline, give an empty 'data'.
+/// @param grid The given grid to be operated on
+/// @param x 
+/// @param y 
+/// @return The cell's former data_t 'data'
+data_t ca_lib_take_cell(ca_lib_grid_t *grid, size_t x, size_t y);
+
 /// @brief Switches the cells at (x1,y1) and (x2, y2)
 /// @param grid The given grid to be operated on
 /// @param x1 cell 1's x
@@ -95,10 +365,19 @@ void ca_lib_move_cell(ca_lib_grid_t *grid, size_t x1, size_t y1, size_t x2, size
 /// @param y2 cell 2's y
 void ca_lib_switch_cells(ca_lib_grid_t *grid, size_t x1, size_t y1, size_t x2, size_t y2);
 
-/// @brief Retrieves the data_t 'data' from the cell at (x,y) in the given grid
-/// @param grid The given grid to be searched
+/// @brief Changes the payload of the non-empty cell at (x,y) with 'modify_func'
+/// Payloads shared through 'ca_lib_alloc_interned_ptr' are copied, modified and interned again - others are modified in place
+/// @param grid The given grid to be operated on
 /// @param x 
 /// @param y 
+/// @param modify_func changes the payload
+/// @param arg passed on to 'modify_func'
+void ca_lib_modify_cell(ca_lib_grid_t *grid, size_t x, size_t y, ca_lib_modify_data_t modify_func, void *arg);
+
+/// @brief Retrieves the data_t 'data' from the cell at (x,y) in the given grid
+/// @param grid The given grid to be searched
+/// @param x -1 to width, where -1 and width are the halo (see 'ca_lib_set_boundary')
+/// @param y -1 to height, where -1 and height are the halo
 /// @return The cell's data_t 'data' NOTE: changing 'data.ptr' will change the data in the original cell
 data_t ca_lib_get_cell_data(ca_lib_grid_t *grid, size_t x, size_t y);
 
@@ -114,7 +393,8 @@ bool ca_lib_cell_empty(ca_lib_grid_t *grid, size_t x, size_t y);
 /// @param convert_func Determines what char the cell will be represented as based on 'data_ptr'
 void ca_lib_print_grid(ca_lib_grid_t *grid, ca_lib_data_to_char_t convert_func);
 
-/// @brief Applies the given simulation function to each cell, uses a buffer to make sure ALL cells are simulated and only ONCE - despite movement
+/// @brief Applies the given simulation function to each cell, stamps cells with the current step to make sure ALL cells are simulated and only ONCE - despite movement
+/// No memory is allocated per step
 /// @param grid The given grid to be operated on
 /// @param sim_func The function which determines how the cells will behave
 void ca_lib_simulate(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func);
@@ -124,6 +404,80 @@ void ca_lib_simulate(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func);
 /// @param sim_func The function which determines how the cells will behave
 void ca_lib_simulate_unabstract(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func);
 
+/// @brief Parallel version of 'ca_lib_simulate_unabstract' - the grid is split into horizontal bands, several per thread
+/// Requires the rule to be declared local-write-only with 'ca_lib_set_local_rule', otherwise the grid is simulated sequentially.
+/// All bands are finished before the function returns.
+/// @param grid The given grid to be operated on
+/// @param sim_func The function which determines how the cells will behave
+void ca_lib_simulate_unabstract_parallel(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func);
+
+/// @brief Parallel drop-in alternative to 'ca_lib_simulate' for rules that move, switch or write neighbouring cells
+/// The grid is split into tiles that are processed in 4 phases, in each phase only tiles two tiles apart are simulated concurrently.
+/// Every abstract cell is still simulated exactly once per step. See 'ca_lib_set_tile_size' for the limit on the rule's reach.
+/// @param grid The given grid to be operated on
+/// @param sim_func The function which determines how the cells will behave
+void ca_lib_simulate_phased(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func);
+
+/// @brief Like 'ca_lib_simulate' but only visits the 'CA_LIB_CHUNK_SIZE' chunks (and their neighbours) that changed since the previous call
+/// Changes are tracked automatically by insert/move/switch/clear, see 'ca_lib_mark_cell_dirty' for in-place changes of 'data.ptr'.
+/// The first call visits the whole grid. Settled regions of the grid cost nothing.
+/// @param grid The given grid to be operated on
+/// @param sim_func The function which determines how the cells will behave
+void ca_lib_simulate_active(ca_lib_grid_t *grid, ca_lib_simulate_cell_t sim_func);
+
+/// @brief Like 'ca_lib_simulate' but hands the rule the cell's neighbourhood, gathered by the engine with the grid's edges already handled
+/// The neighbourhood is gathered right before each cell is simulated, so it reflects movement earlier in the step.
+/// @param grid The given grid to be operated on
+/// @param kind The shape of the neighbourhood
+/// @param radius The reach of the neighbourhood, 1 for the 8 (Moore) or 4 (von Neumann) closest cells
+/// @param sim_func The function which determines how the cells will behave
+void ca_lib_simulate_neighbourhood(ca_lib_grid_t *grid, ca_lib_neighbourhood_kind_t kind, int radius, ca_lib_simulate_neighbourhood_t sim_func);
+
+/// @brief Like 'ca_lib_simulate_neighbourhood' but synchronous - every neighbourhood shows the previous generation, however far the step has come
+/// 'data->ptr' is the cell's slot in the back buffer, holding a copy of its previous payload for the rule to overwrite - it may not
+/// be reassigned, and the grid may not be changed any other way during the step. Rows are split into bands, several per thread
+/// (see 'ca_lib_set_thread_count'), whatever the rule's reach. Does nothing without 'ca_lib_enable_double_buffer'.
+/// @param grid The given grid to be operated on
+/// @param kind The shape of the neighbourhood
+/// @param radius The reach of the neighbourhood
+/// @param sim_func The function which writes the cell's next payload
+void ca_lib_simulate_sync(ca_lib_grid_t *grid, ca_lib_neighbourhood_kind_t kind, int radius, ca_lib_simulate_neighbourhood_t sim_func);
+
+/// @brief Moves cells in parallel without conflicts - every cell states where it wants to move, then the library decides
+/// In the first phase the rule is called on every cell, and may only read the grid. Then every destination picks one of the
+/// cells that want it: the highest priority, ties broken by a hash of the generation and seed (see 'ca_lib_set_seed'), then
+/// by position. A cell that won its destination swaps places with it, unless the destination's occupant won a move of its own -
+/// then the cell waits for a later step, which keeps every swap apart from the others. The outcome doesn't depend on the
+/// thread count or the order cells are visited in. Phases run on all threads (see 'ca_lib_set_thread_count').
+/// @param grid The given grid to be operated on
+/// @param intent_func The function which decides where a cell wants to move
+void ca_lib_simulate_intents(ca_lib_grid_t *grid, ca_lib_simulate_intent_t intent_func);
+
+/// @brief Margolus neighbourhood - splits the grid into 2x2 blocks and hands every block to the rule
+/// The blocks start at even coordinates when the generation the step starts from (see 'ca_lib_get_generation') is even,
+/// and at odd ones otherwise, so consecutive steps overlap. Blocks that don't fit inside the grid are left out. The rule
+/// may only read and write its own block, which lets rows of blocks run on all threads (see 'ca_lib_set_thread_count').
+/// Typed grids: entries may be permuted or written in place. Other grids: 'ptr' may also be reassigned, like 'ca_lib_simulate'.
+/// @param grid The given grid to be operated on
+/// @param block_func The function which determines how the blocks will behave
+void ca_lib_simulate_margolus(ca_lib_grid_t *grid, ca_lib_simulate_block_t block_func);
+
+/// @brief Applies the given row function to every row of a typed grid - one call per row rather than per cell
+/// Rows are split into bands, several per thread (see 'ca_lib_set_thread_count'). Does nothing on grids not created by 'ca_lib_create_typed_grid'.
+/// @param grid The given grid to be operated on
+/// @param row_func The function which computes the next generation of a row
+void ca_lib_simulate_rows(ca_lib_grid_t *grid, ca_lib_simulate_row_t row_func);
+
+/// @brief Like 'ca_lib_simulate_rows' 'steps' times over, but advances one tile at a time all 'steps' generations while it's in cache
+/// Each tile (see 'ca_lib_set_tile_size') is simulated together with a 'steps' wide margin, so the rule is handed spans of rows
+/// rather than whole rows: 'width' is the span's length and its ends must be treated like the grid's edges. The result only
+/// matches 'ca_lib_simulate_rows' for rules that depend on nothing but the rows handed to them - not on x, the generation
+/// or 'ca_lib_random'. Tiles are shared out between the threads. Cycle detection only sees every 'steps':th generation.
+/// @param grid The given grid to be operated on
+/// @param row_func The function which computes the next generation of a span of a row
+/// @param steps Number of generations to advance
+void ca_lib_simulate_rows_blocked(ca_lib_grid_t *grid, ca_lib_simulate_row_t row_func, size_t steps);
+
 /// @brief Start a gfx graphics simulation - and simulate the grid for 'iteration' times
 /// @param grid the given grid to be simulated
 /// @param sim_func the function to be called each iteration
@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdalign.h>
+#include <string.h>
+#include <pthread.h>
+#include "ca_lib_arena.h"
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+struct region
+{
+    struct region *next;
+    size_t size; // Bytes in 'bytes'
+    size_t used; // Bytes handed out since the region was last rewound
+    alignas(max_align_t) unsigned char bytes[];
+};
+typedef struct region region_t;
+
+struct arena
+{
+    pthread_mutex_t lock;
+    region_t *regions; // Every region, in the order they are filled
+    region_t *current; // The region payloads are being carved out of - the ones after it are empty
+};
+
+// Serves 'ca_lib_alloc_arena_ptr' outside of any grid - lives as long as the process
+static ca_lib_arena_t shared_arena = {PTHREAD_MUTEX_INITIALIZER, NULL, NULL};
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+static size_t align_up(size_t size)
+{
+    return (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+}
+
+// Link a new region of at least 'size' bytes in right after the current one - the caller holds the lock
+static region_t *new_region(ca_lib_arena_t *arena, size_t size)
+{
+    size = size > CA_LIB_ARENA_REGION_SIZE ? size : CA_LIB_ARENA_REGION_SIZE;
+    region_t *region = malloc(sizeof(region_t) + size);
+    if (!region) { return NULL; }
+    region->size = size;
+    region->used = 0;
+    if (arena->current)
+    {
+        region->next = arena->current->next;
+        arena->current->next = region;
+    }
+    else
+    {
+        region->next = arena->regions;
+        arena->regions = region;
+    }
+    return region;
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_arena_t *ca_lib_create_arena(void)
+{
+    ca_lib_arena_t *arena = calloc(1, sizeof(ca_lib_arena_t));
+    pthread_mutex_init(&arena->lock, NULL);
+    return arena;
+}
+
+ca_lib_arena_t *ca_lib_shared_arena(void)
+{
+    return &shared_arena;
+}
+
+ca_lib_arena_t *ca_lib_destroy_arena(ca_lib_arena_t *arena)
+{
+    region_t *region = arena->regions;
+    while (region)
+    {
+        region_t *next = region->next;
+        free(region);
+        region = next;
+    }
+    pthread_mutex_destroy(&arena->lock);
+    free(arena);
+    return NULL;
+}
+
+void *ca_lib_arena_alloc(ca_lib_arena_t *arena, void *data_ptr, size_t data_size)
+{
+    size_t size = align_up(data_size > 0 ? data_size : 1);
+    pthread_mutex_lock(&arena->lock);
+
+    // Move on through the regions kept from before the last rewind, then grow
+    region_t *region = arena->current;
+    while (region && region->size - region->used < size)
+    {
+        region = region->next;
+    }
+    if (!region) { region = new_region(arena, size); }
+    if (!region)
+    {
+        pthread_mutex_unlock(&arena->lock);
+        return NULL;
+    }
+    arena->current = region;
+    void *payload = region->bytes + region->used;
+    region->used += size;
+
+    pthread_mutex_unlock(&arena->lock);
+    if (data_size > 0) { memcpy(payload, data_ptr, data_size); }
+    return payload;
+}
+
+void ca_lib_rewind_arena(ca_lib_arena_t *arena)
+{
+    pthread_mutex_lock(&arena->lock);
+    for (region_t *region = arena->regions; region; region = region->next)
+    {
+        region->used = 0;
+    }
+    arena->current = arena->regions;
+    pthread_mutex_unlock(&arena->lock);
+}
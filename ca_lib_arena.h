@@ -0,0 +1,35 @@
+#pragma once
+#include <stdlib.h>
+
+// ca-lib arena - bump allocator behind 'ca_lib_alloc_arena_ptr' / 'ca_lib_free_arena_ptr'
+// Not part of the user-reachable interface, grids created with the arena pair get an arena of their own
+
+// Size of the regions the arena carves payloads out of - larger payloads get a region of their own
+#define CA_LIB_ARENA_REGION_SIZE ((size_t)1 << 16)
+
+typedef struct arena ca_lib_arena_t;
+
+/// @brief Creates an empty arena
+/// @return the allocated arena
+ca_lib_arena_t *ca_lib_create_arena(void);
+
+/// @brief The process-wide arena used when the arena allocator pair is called directly
+/// @return the shared arena - never rewound or destroyed, it only grows
+ca_lib_arena_t *ca_lib_shared_arena(void);
+
+/// @brief Frees the arena and all of its regions at once
+/// @param arena
+/// @return NULL
+ca_lib_arena_t *ca_lib_destroy_arena(ca_lib_arena_t *arena);
+
+/// @brief Allocates 'data_size' bytes from the arena and copies over 'data_ptr' - thread safe
+/// @param arena
+/// @param data_ptr may only be NULL if 'data_size' is 0
+/// @param data_size
+/// @return the payload, valid until the arena is rewound or destroyed
+void *ca_lib_arena_alloc(ca_lib_arena_t *arena, void *data_ptr, size_t data_size);
+
+/// @brief Makes all of the arena's memory available again - every payload allocated from it becomes invalid
+/// The regions are kept for reuse, so a rewound arena allocates without calling malloc until it outgrows them
+/// @param arena
+void ca_lib_rewind_arena(ca_lib_arena_t *arena);
@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include "ca_lib_bit_grid.h"
+
+/*----VECTOR OPERATIONS----*/
+
+// The kernel is written once against these operations, which work on 'VEC_WORDS' 64-bit words at a time
+#if defined(__AVX2__)
+#include <immintrin.h>
+typedef __m256i vec_t;
+#define VEC_WORDS 4
+#define vec_load(p) _mm256_loadu_si256((const __m256i *)(p))
+#define vec_store(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define vec_and(a, b) _mm256_and_si256((a), (b))
+#define vec_or(a, b) _mm256_or_si256((a), (b))
+#define vec_xor(a, b) _mm256_xor_si256((a), (b))
+#define vec_andnot(a, b) _mm256_andnot_si256((a), (b)) // ~a & b
+#define vec_shl(v, n) _mm256_slli_epi64((v), (n))
+#define vec_shr(v, n) _mm256_srli_epi64((v), (n))
+#define vec_zero() _mm256_setzero_si256()
+#define vec_ones() _mm256_set1_epi64x(-1)
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+typedef __m128i vec_t;
+#define VEC_WORDS 2
+#define vec_load(p) _mm_loadu_si128((const __m128i *)(p))
+#define vec_store(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define vec_and(a, b) _mm_and_si128((a), (b))
+#define vec_or(a, b) _mm_or_si128((a), (b))
+#define vec_xor(a, b) _mm_xor_si128((a), (b))
+#define vec_andnot(a, b) _mm_andnot_si128((a), (b)) // ~a & b
+#define vec_shl(v, n) _mm_slli_epi64((v), (n))
+#define vec_shr(v, n) _mm_srli_epi64((v), (n))
+#define vec_zero() _mm_setzero_si128()
+#define vec_ones() _mm_set1_epi64x(-1)
+#else
+typedef uint64_t vec_t;
+#define VEC_WORDS 1
+#define vec_load(p) (*(const uint64_t *)(p))
+#define vec_store(p, v) (*(uint64_t *)(p) = (v))
+#define vec_and(a, b) ((a) & (b))
+#define vec_or(a, b) ((a) | (b))
+#define vec_xor(a, b) ((a) ^ (b))
+#define vec_andnot(a, b) (~(a) & (b))
+#define vec_shl(v, n) ((v) << (n))
+#define vec_shr(v, n) ((v) >> (n))
+#define vec_zero() ((uint64_t)0)
+#define vec_ones() (~(uint64_t)0)
+#endif
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+// Cell (x,y) is bit x % 64 of word 1 + x / 64 in row y + 1 - every row is padded with a dead word on each side,
+// and a dead row above and below the grid, so the kernel never has to check the edges
+struct bit_grid
+{
+    size_t width;
+    size_t height;
+    size_t row_words; // Words actually holding cells in each row
+    size_t stride; // Words per padded row - a multiple of 'VEC_WORDS' plus the two padding words
+    uint64_t last_word_mask; // Valid bits of the last word of each row
+    uint64_t *cells; // Current generation, ('height' + 2) * 'stride' words
+    uint64_t *next; // Buffer the next generation is written to before the two are swapped
+};
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+static uint64_t *row_at(ca_lib_bit_grid_t *grid, uint64_t *buf, size_t y)
+{
+    return &buf[(y + 1) * grid->stride];
+}
+
+// Computes the next state of 'VEC_WORDS' words starting at word 'w' of the row 'mid'
+static inline vec_t step_words(const uint64_t *up, const uint64_t *mid, const uint64_t *down, size_t w, const uint16_t rule[2])
+{
+    // The eight neighbours of every bit, aligned with the bit itself
+    vec_t u = vec_load(up + w), m = vec_load(mid + w), d = vec_load(down + w);
+    vec_t ul = vec_or(vec_shl(u, 1), vec_shr(vec_load(up + w - 1), 63));
+    vec_t ur = vec_or(vec_shr(u, 1), vec_shl(vec_load(up + w + 1), 63));
+    vec_t ml = vec_or(vec_shl(m, 1), vec_shr(vec_load(mid + w - 1), 63));
+    vec_t mr = vec_or(vec_shr(m, 1), vec_shl(vec_load(mid + w + 1), 63));
+    vec_t dl = vec_or(vec_shl(d, 1), vec_shr(vec_load(down + w - 1), 63));
+    vec_t dr = vec_or(vec_shr(d, 1), vec_shl(vec_load(down + w + 1), 63));
+
+    // Bit-sliced adder tree - the neighbour count of every bit ends up in the planes 'b0' to 'b3'
+    vec_t s0 = vec_xor(vec_xor(ul, u), ur);
+    vec_t c0 = vec_or(vec_and(ul, u), vec_and(ur, vec_xor(ul, u)));
+    vec_t s1 = vec_xor(vec_xor(ml, mr), dl);
+    vec_t c1 = vec_or(vec_and(ml, mr), vec_and(dl, vec_xor(ml, mr)));
+    vec_t s2 = vec_xor(d, dr);
+    vec_t c2 = vec_and(d, dr);
+
+    vec_t b0 = vec_xor(vec_xor(s0, s1), s2);
+    vec_t ca = vec_or(vec_and(s0, s1), vec_and(s2, vec_xor(s0, s1)));
+
+    vec_t t = vec_xor(vec_xor(c0, c1), c2);
+    vec_t tc = vec_or(vec_and(c0, c1), vec_and(c2, vec_xor(c0, c1)));
+    vec_t b1 = vec_xor(t, ca);
+    vec_t tc2 = vec_and(t, ca);
+
+    vec_t b2 = vec_xor(tc, tc2);
+    vec_t b3 = vec_and(tc, tc2);
+
+    // Apply the rule - 'rule[0]' is the birth mask and 'rule[1]' the survival mask
+    vec_t ones = vec_ones();
+    vec_t nb0 = vec_andnot(b0, ones), nb1 = vec_andnot(b1, ones), nb2 = vec_andnot(b2, ones), nb3 = vec_andnot(b3, ones);
+    vec_t result = vec_zero();
+    for (int n = 0; n <= 8; n++)
+    {
+        bool born = rule[0] >> n & 1;
+        bool survives = rule[1] >> n & 1;
+        if (!born && !survives) { continue; }
+        vec_t count_is_n = vec_and(vec_and(n & 1 ? b0 : nb0, n & 2 ? b1 : nb1), vec_and(n & 4 ? b2 : nb2, n & 8 ? b3 : nb3));
+        if (born && survives) { result = vec_or(result, count_is_n); }
+        else if (born) { result = vec_or(result, vec_andnot(m, count_is_n)); }
+        else { result = vec_or(result, vec_and(m, count_is_n)); }
+    }
+    return result;
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_bit_grid_t *ca_lib_create_bit_grid(size_t width, size_t height)
+{
+    ca_lib_bit_grid_t *grid = calloc(1, sizeof(ca_lib_bit_grid_t));
+    grid->width = width;
+    grid->height = height;
+    grid->row_words = (width + 63) / 64;
+    grid->stride = (grid->row_words + VEC_WORDS - 1) / VEC_WORDS * VEC_WORDS + 2;
+    grid->last_word_mask = width % 64 ? ((uint64_t)1 << (width % 64)) - 1 : ~(uint64_t)0;
+    grid->cells = calloc((height + 2) * grid->stride, sizeof(uint64_t));
+    grid->next = calloc((height + 2) * grid->stride, sizeof(uint64_t));
+    return grid;
+}
+
+ca_lib_bit_grid_t *ca_lib_destroy_bit_grid(ca_lib_bit_grid_t *grid)
+{
+    free(grid->cells);
+    free(grid->next);
+    free(grid);
+    return NULL;
+}
+
+size_t ca_lib_get_bit_grid_width(ca_lib_bit_grid_t *grid)
+{
+    return grid->width;
+}
+
+size_t ca_lib_get_bit_grid_height(ca_lib_bit_grid_t *grid)
+{
+    return grid->height;
+}
+
+void ca_lib_bit_grid_set(ca_lib_bit_grid_t *grid, size_t x, size_t y, bool alive)
+{
+    if (x >= grid->width || y >= grid->height) { return; }
+    uint64_t *word = &row_at(grid, grid->cells, y)[1 + x / 64];
+    uint64_t bit = (uint64_t)1 << (x % 64);
+    *word = alive ? *word | bit : *word & ~bit;
+}
+
+bool ca_lib_bit_grid_get(ca_lib_bit_grid_t *grid, size_t x, size_t y)
+{
+    if (x >= grid->width || y >= grid->height) { return false; }
+    return row_at(grid, grid->cells, y)[1 + x / 64] >> (x % 64) & 1;
+}
+
+size_t ca_lib_bit_grid_population(ca_lib_bit_grid_t *grid)
+{
+    size_t population = 0;
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        uint64_t *row = row_at(grid, grid->cells, y);
+        for (size_t w = 1; w <= grid->row_words; w++)
+        {
+            population += __builtin_popcountll(row[w]);
+        }
+    }
+    return population;
+}
+
+void ca_lib_bit_grid_step(ca_lib_bit_grid_t *grid, uint16_t birth, uint16_t survival)
+{
+    const uint16_t rule[2] = {birth, survival};
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        const uint64_t *up = row_at(grid, grid->cells, y - 1);
+        const uint64_t *mid = row_at(grid, grid->cells, y);
+        const uint64_t *down = row_at(grid, grid->cells, y + 1);
+        uint64_t *out = row_at(grid, grid->next, y);
+        for (size_t w = 1; w <= grid->row_words; w += VEC_WORDS)
+        {
+            vec_store(out + w, step_words(up, mid, down, w, rule));
+        }
+        // Cells past the edge of the grid must stay dead
+        out[grid->row_words] &= grid->last_word_mask;
+        memset(out + grid->row_words + 1, 0, (grid->stride - grid->row_words - 1) * sizeof(uint64_t));
+    }
+
+    uint64_t *tmp = grid->cells;
+    grid->cells = grid->next;
+    grid->next = tmp;
+}
+
+void ca_lib_print_bit_grid(ca_lib_bit_grid_t *grid)
+{
+    printf("\n| BIT GRID [%d , %d] |\n", (int)grid->width, (int)grid->height);
+    for (int y = (int)grid->height - 1; y >= 0; y--)
+    {
+        for (size_t x = 0; x < grid->width; x++)
+        {
+            putchar(ca_lib_bit_grid_get(grid, x, (size_t)y) ? '#' : '.');
+        }
+        puts("");
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// ca-lib bit grid - a dedicated 2-state grid storing 64 cells per word, stepped with Life-like rules
+
+/// @brief Birth/survival masks are 9-bit masks - bit n set means "with n live neighbours"
+#define CA_LIB_NEIGHBOURS(n) (1u << (n))
+
+// Conway's Game of Life - B3/S23
+#define CA_LIB_LIFE_BIRTH (CA_LIB_NEIGHBOURS(3))
+#define CA_LIB_LIFE_SURVIVAL (CA_LIB_NEIGHBOURS(2) | CA_LIB_NEIGHBOURS(3))
+
+typedef struct bit_grid ca_lib_bit_grid_t;
+
+/*----FUNCTION HEADERS----*/
+
+/// @brief Creates a 'width' by 'height' grid of dead cells, every cell is a single bit
+/// Cells outside of the grid are always dead.
+/// @param width
+/// @param height
+/// @return a pointer to the allocated bit grid
+ca_lib_bit_grid_t *ca_lib_create_bit_grid(size_t width, size_t height);
+
+/// @brief Frees the given bit grid and returns NULL
+/// @param grid
+/// @return NULL
+ca_lib_bit_grid_t *ca_lib_destroy_bit_grid(ca_lib_bit_grid_t *grid);
+
+size_t ca_lib_get_bit_grid_width(ca_lib_bit_grid_t *grid);
+
+size_t ca_lib_get_bit_grid_height(ca_lib_bit_grid_t *grid);
+
+/// @brief Sets the cell at (x,y) to alive or dead - does nothing outside of the grid
+/// @param grid
+/// @param x
+/// @param y
+/// @param alive
+void ca_lib_bit_grid_set(ca_lib_bit_grid_t *grid, size_t x, size_t y, bool alive);
+
+/// @brief Checks whether the cell at (x,y) is alive - cells outside of the grid are dead
+/// @param grid
+/// @param x
+/// @param y
+/// @return true if alive, otherwise false
+bool ca_lib_bit_grid_get(ca_lib_bit_grid_t *grid, size_t x, size_t y);
+
+/// @brief Counts the live cells of the grid
+/// @param grid
+/// @return the number of live cells
+size_t ca_lib_bit_grid_population(ca_lib_bit_grid_t *grid);
+
+/// @brief Advances the grid one generation with the Life-like rule given by 'birth' and 'survival' (see 'CA_LIB_NEIGHBOURS')
+/// Uses a bit-sliced neighbour counter on whole words - with AVX2 or SSE2 when the compiler targets them.
+/// @param grid
+/// @param birth a dead cell with n live neighbours becomes alive if bit n is set
+/// @param survival a live cell with n live neighbours stays alive if bit n is set
+void ca_lib_bit_grid_step(ca_lib_bit_grid_t *grid, uint16_t birth, uint16_t survival);
+
+/// @brief Prints a simple representation of the given 'grid' - '#' for alive and '.' for dead
+/// @param grid
+void ca_lib_print_bit_grid(ca_lib_bit_grid_t *grid);
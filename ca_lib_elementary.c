@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "ca_lib_elementary.h"
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+// Cell x is bit x % 64 of word x / 64
+struct elementary
+{
+    size_t width;
+    size_t words; // Words per row
+    uint64_t last_word_mask; // Valid bits of the last word
+    bool wrap;
+    bool totalistic;
+    uint8_t rule; // Wolfram code of elementary automata
+    uint64_t code; // Rule code of totalistic automata
+    unsigned int radius;
+    uint64_t *cells; // The current generation
+    uint64_t *neighbours; // Scratch - row shifted by -radius up to +radius, (2 * radius + 1) * 'words' words
+};
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+static uint64_t word_or_zero(const uint64_t *src, size_t words, long i)
+{
+    return i >= 0 && (size_t)i < words ? src[i] : 0;
+}
+
+// Bit x of 'dst' becomes bit x + 'shift' of 'src' (0 outside of 'src') - ORed into 'dst' if 'or_into' is set
+static void shift_cells(const uint64_t *src, uint64_t *dst, size_t words, long shift, bool or_into)
+{
+    long q = shift >= 0 ? shift / 64 : -(-shift / 64);
+    int r = (int)((shift >= 0 ? shift : -shift) % 64);
+    for (long w = 0; w < (long)words; w++)
+    {
+        uint64_t word;
+        if (shift >= 0)
+        {
+            word = word_or_zero(src, words, w + q) >> r;
+            if (r) { word |= word_or_zero(src, words, w + q + 1) << (64 - r); }
+        }
+        else
+        {
+            word = word_or_zero(src, words, w + q) << r;
+            if (r) { word |= word_or_zero(src, words, w + q - 1) >> (64 - r); }
+        }
+        dst[w] = or_into ? dst[w] | word : word;
+    }
+}
+
+// Bit x of 'dst' becomes the state of cell x + 'offset', following the automaton's boundary
+static void neighbour_row(ca_lib_elementary_t *ca, long offset, uint64_t *dst)
+{
+    if (ca->wrap && ca->width > 0) { offset %= (long)ca->width; } // A radius past the width wraps around more than once
+    shift_cells(ca->cells, dst, ca->words, offset, false);
+    if (ca->wrap && offset != 0)
+    {
+        // Cells that fell off one end come back in at the other
+        long width = (long)ca->width;
+        shift_cells(ca->cells, dst, ca->words, offset > 0 ? offset - width : offset + width, true);
+    }
+    dst[ca->words - 1] &= ca->last_word_mask;
+}
+
+static ca_lib_elementary_t *create_elementary(size_t width, unsigned int radius, bool wrap)
+{
+    ca_lib_elementary_t *ca = calloc(1, sizeof(ca_lib_elementary_t));
+    ca->width = width;
+    ca->words = width > 0 ? (width + 63) / 64 : 1;
+    ca->last_word_mask = width % 64 ? ((uint64_t)1 << (width % 64)) - 1 : ~(uint64_t)0;
+    ca->wrap = wrap;
+    ca->radius = radius;
+    ca->cells = calloc(ca->words, sizeof(uint64_t));
+    ca->neighbours = calloc((2 * radius + 1) * ca->words, sizeof(uint64_t));
+    return ca;
+}
+
+static void step_wolfram(ca_lib_elementary_t *ca)
+{
+    uint64_t *left = ca->neighbours;
+    uint64_t *right = ca->neighbours + 2 * ca->words;
+    neighbour_row(ca, -1, left);
+    neighbour_row(ca, 1, right);
+    for (size_t w = 0; w < ca->words; w++)
+    {
+        uint64_t l = left[w], c = ca->cells[w], r = right[w];
+        uint64_t next = 0;
+        for (int pattern = 0; pattern < 8; pattern++)
+        {
+            if (!(ca->rule >> pattern & 1)) { continue; }
+            next |= (pattern & 4 ? l : ~l) & (pattern & 2 ? c : ~c) & (pattern & 1 ? r : ~r);
+        }
+        ca->cells[w] = next;
+    }
+}
+
+static void step_totalistic(ca_lib_elementary_t *ca)
+{
+    size_t rows = 2 * ca->radius + 1;
+    for (size_t i = 0; i < rows; i++)
+    {
+        neighbour_row(ca, (long)i - (long)ca->radius, ca->neighbours + i * ca->words);
+    }
+    for (size_t w = 0; w < ca->words; w++)
+    {
+        // Bit-sliced sum of the neighbourhood of all 64 cells
+        uint64_t planes[6] = {0};
+        for (size_t i = 0; i < rows; i++)
+        {
+            uint64_t carry = ca->neighbours[i * ca->words + w];
+            for (int b = 0; b < 6 && carry; b++)
+            {
+                uint64_t c = planes[b] & carry;
+                planes[b] ^= carry;
+                carry = c;
+            }
+        }
+        uint64_t next = 0;
+        for (size_t sum = 0; sum <= rows; sum++)
+        {
+            if (!(ca->code >> sum & 1)) { continue; }
+            uint64_t sum_matches = ~(uint64_t)0;
+            for (int b = 0; b < 6; b++)
+            {
+                sum_matches &= sum >> b & 1 ? planes[b] : ~planes[b];
+            }
+            next |= sum_matches;
+        }
+        ca->cells[w] = next;
+    }
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_elementary_t *ca_lib_create_elementary(size_t width, uint8_t rule, bool wrap)
+{
+    ca_lib_elementary_t *ca = create_elementary(width, 1, wrap);
+    ca->rule = rule;
+    return ca;
+}
+
+ca_lib_elementary_t *ca_lib_create_totalistic(size_t width, unsigned int radius, uint64_t code, bool wrap)
+{
+    if (radius < 1 || radius > CA_LIB_ELEMENTARY_MAX_RADIUS) { return NULL; }
+    ca_lib_elementary_t *ca = create_elementary(width, radius, wrap);
+    ca->totalistic = true;
+    ca->code = code;
+    return ca;
+}
+
+ca_lib_elementary_t *ca_lib_destroy_elementary(ca_lib_elementary_t *ca)
+{
+    free(ca->cells);
+    free(ca->neighbours);
+    free(ca);
+    return NULL;
+}
+
+size_t ca_lib_get_elementary_width(ca_lib_elementary_t *ca)
+{
+    return ca->width;
+}
+
+void ca_lib_elementary_set(ca_lib_elementary_t *ca, size_t x, bool alive)
+{
+    if (x >= ca->width) { return; }
+    uint64_t bit = (uint64_t)1 << (x % 64);
+    ca->cells[x / 64] = alive ? ca->cells[x / 64] | bit : ca->cells[x / 64] & ~bit;
+}
+
+bool ca_lib_elementary_get(ca_lib_elementary_t *ca, size_t x)
+{
+    if (x >= ca->width) { return false; }
+    return ca->cells[x / 64] >> (x % 64) & 1;
+}
+
+void ca_lib_elementary_step(ca_lib_elementary_t *ca)
+{
+    if (ca->width == 0) { return; }
+    if (ca->totalistic) { step_totalistic(ca); }
+    else { step_wolfram(ca); }
+    ca->cells[ca->words - 1] &= ca->last_word_mask; // Cells past the end must stay dead
+}
+
+void ca_lib_elementary_write_row(ca_lib_elementary_t *ca, ca_lib_grid_t *grid, size_t y, size_t data_size, void *alive_data)
+{
+    size_t width = ca->width < ca_lib_get_grid_width(grid) ? ca->width : ca_lib_get_grid_width(grid);
+    for (size_t x = 0; x < width; x++)
+    {
+        if (ca_lib_elementary_get(ca, x)) { ca_lib_insert_cell(grid, x, y, data_size, alive_data); }
+        else { ca_lib_clear_cell(grid, x, y); }
+    }
+}
+
+void ca_lib_elementary_write_history(ca_lib_elementary_t *ca, ca_lib_grid_t *grid, size_t data_size, void *alive_data)
+{
+    size_t height = ca_lib_get_grid_height(grid);
+    for (size_t t = 0; t < height; t++)
+    {
+        if (t > 0) { ca_lib_elementary_step(ca); }
+        ca_lib_elementary_write_row(ca, grid, height - 1 - t, data_size, alive_data);
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "ca_lib.h"
+
+// ca-lib elementary - one dimensional 2-state automata stepped 64 cells per word operation
+
+// Largest radius of totalistic rules - the neighbourhood sum has to fit the 64 bits of the rule code
+#define CA_LIB_ELEMENTARY_MAX_RADIUS 31
+
+typedef struct elementary ca_lib_elementary_t;
+
+/*----FUNCTION HEADERS----*/
+
+/// @brief Creates a row of 'width' dead cells ruled by the Wolfram rule 'rule'
+/// @param width
+/// @param rule Wolfram code 0-255 - bit 4*left + 2*centre + right is the next state of that neighbourhood
+/// @param wrap true if the row wraps around, otherwise cells outside of the row are dead
+/// @return the allocated automaton
+ca_lib_elementary_t *ca_lib_create_elementary(size_t width, uint8_t rule, bool wrap);
+
+/// @brief Creates a row of 'width' dead cells ruled by a totalistic rule of the given radius
+/// @param width
+/// @param radius number of cells on each side in the neighbourhood, 1 to 'CA_LIB_ELEMENTARY_MAX_RADIUS' - on a wrapping
+/// row narrower than the neighbourhood, cells are counted once for every time the neighbourhood reaches them
+/// @param code bit n is the next state of a cell whose neighbourhood (itself included) has n live cells
+/// @param wrap true if the row wraps around, otherwise cells outside of the row are dead
+/// @return the allocated automaton, or NULL if 'radius' is out of range
+ca_lib_elementary_t *ca_lib_create_totalistic(size_t width, unsigned int radius, uint64_t code, bool wrap);
+
+/// @brief Frees the given automaton and returns NULL
+/// @param ca
+/// @return NULL
+ca_lib_elementary_t *ca_lib_destroy_elementary(ca_lib_elementary_t *ca);
+
+size_t ca_lib_get_elementary_width(ca_lib_elementary_t *ca);
+
+/// @brief Sets cell 'x' to alive or dead - does nothing outside of the row
+/// @param ca
+/// @param x
+/// @param alive
+void ca_lib_elementary_set(ca_lib_elementary_t *ca, size_t x, bool alive);
+
+/// @brief Checks whether cell 'x' is alive
+/// @param ca
+/// @param x
+/// @return true if alive, otherwise false
+bool ca_lib_elementary_get(ca_lib_elementary_t *ca, size_t x);
+
+/// @brief Advances the row one generation, 64 cells at a time
+/// @param ca
+void ca_lib_elementary_step(ca_lib_elementary_t *ca);
+
+/// @brief Writes the current generation into row 'y' of 'grid' - live cells get 'alive_data' inserted, dead cells are cleared
+/// @param ca
+/// @param grid the grid to write to
+/// @param y the row to write
+/// @param data_size size of 'alive_data' in bytes
+/// @param alive_data the data inserted into live cells
+void ca_lib_elementary_write_row(ca_lib_elementary_t *ca, ca_lib_grid_t *grid, size_t y, size_t data_size, void *alive_data);
+
+/// @brief Fills 'grid' with the space-time history of the automaton, one generation per row
+/// The current generation is written to the top row (y = height - 1), and every row below it is one generation later,
+/// so time runs downwards when rendered by 'ca_lib_start_graphics_simulation'. The automaton ends up at the last generation written.
+/// @param ca
+/// @param grid the grid to write to
+/// @param data_size size of 'alive_data' in bytes
+/// @param alive_data the data inserted into live cells
+void ca_lib_elementary_write_history(ca_lib_elementary_t *ca, ca_lib_grid_t *grid, size_t data_size, void *alive_data);
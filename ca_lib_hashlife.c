@@ -0,0 +1,454 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "ca_lib_hashlife.h"
+
+#define NODES_PER_BLOCK 4096
+#define MAX_LEVEL 63
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+// A 2^level by 2^level square of cells - level 0 nodes are single cells
+// Nodes are canonical: two nodes with the same contents are the same node, so they can be compared by pointer
+struct node
+{
+    struct node *nw; // Quadrants, NULL for level 0 - north is towards lower y, west towards lower x
+    struct node *ne;
+    struct node *sw;
+    struct node *se;
+    struct node *result; // Memoised centre of the node advanced 2^'result_step' generations
+    struct node *next; // Next node in the same bucket of the node table
+    uint64_t population;
+    uint64_t hash;
+    int level;
+    int result_step;
+};
+typedef struct node node_t;
+
+struct node_block
+{
+    struct node_block *next;
+    size_t used;
+    node_t nodes[NODES_PER_BLOCK];
+};
+typedef struct node_block node_block_t;
+
+struct hashlife
+{
+    uint16_t birth;
+    uint16_t survival;
+    node_t dead; // The two level 0 nodes
+    node_t alive;
+    node_t **buckets; // Node table used to canonicalise nodes - the nodes themselves are chained through 'next'
+    size_t bucket_count; // Always a power of 2
+    size_t node_count;
+    node_block_t *blocks; // All nodes above level 0 are allocated from these blocks
+    node_t *empty[MAX_LEVEL + 1]; // Canonical empty node of each level, created on demand
+    node_t *root;
+    int64_t origin_x; // Coordinates of the root's north west cell
+    int64_t origin_y;
+    uint64_t generation;
+};
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+static uint64_t mix(uint64_t h)
+{
+    // SplitMix64 finaliser
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+static uint64_t children_hash(node_t *nw, node_t *ne, node_t *sw, node_t *se)
+{
+    return mix(nw->hash + 3 * mix(ne->hash + 5 * mix(sw->hash + 7 * se->hash)));
+}
+
+static node_t *alloc_node(ca_lib_hashlife_t *hl)
+{
+    if (!hl->blocks || hl->blocks->used == NODES_PER_BLOCK)
+    {
+        node_block_t *block = calloc(1, sizeof(node_block_t));
+        block->next = hl->blocks;
+        hl->blocks = block;
+    }
+    return &hl->blocks->nodes[hl->blocks->used++];
+}
+
+static void grow_table(ca_lib_hashlife_t *hl)
+{
+    size_t bucket_count = hl->bucket_count * 2;
+    node_t **buckets = calloc(bucket_count, sizeof(node_t *));
+    for (size_t b = 0; b < hl->bucket_count; b++)
+    {
+        node_t *node = hl->buckets[b];
+        while (node)
+        {
+            node_t *next = node->next;
+            size_t i = node->hash & (bucket_count - 1);
+            node->next = buckets[i];
+            buckets[i] = node;
+            node = next;
+        }
+    }
+    free(hl->buckets);
+    hl->buckets = buckets;
+    hl->bucket_count = bucket_count;
+}
+
+// Returns the canonical node with the given quadrants, creating it if it doesn't exist yet
+static node_t *join(ca_lib_hashlife_t *hl, node_t *nw, node_t *ne, node_t *sw, node_t *se)
+{
+    uint64_t hash = children_hash(nw, ne, sw, se);
+    node_t **bucket = &hl->buckets[hash & (hl->bucket_count - 1)];
+    for (node_t *node = *bucket; node; node = node->next)
+    {
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se) { return node; }
+    }
+
+    node_t *node = alloc_node(hl);
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->level = nw->level + 1;
+    node->population = nw->population + ne->population + sw->population + se->population;
+    node->hash = hash;
+    node->next = *bucket;
+    *bucket = node;
+
+    if (++hl->node_count > hl->bucket_count) { grow_table(hl); }
+    return node;
+}
+
+static node_t *empty_node(ca_lib_hashlife_t *hl, int level)
+{
+    if (level == 0) { return &hl->dead; }
+    if (!hl->empty[level])
+    {
+        node_t *e = empty_node(hl, level - 1);
+        hl->empty[level] = join(hl, e, e, e, e);
+    }
+    return hl->empty[level];
+}
+
+// Is all of the population within the innermost sixteenth of the node?
+static bool is_padded(node_t *node)
+{
+    return node->level >= 3 &&
+           node->nw->population == node->nw->se->se->population &&
+           node->ne->population == node->ne->sw->sw->population &&
+           node->sw->population == node->sw->ne->ne->population &&
+           node->se->population == node->se->nw->nw->population;
+}
+
+// Surround the root with empty space, doubling its side while keeping it centred
+static void expand(ca_lib_hashlife_t *hl)
+{
+    node_t *root = hl->root;
+    node_t *e = empty_node(hl, root->level - 1);
+    hl->root = join(hl, join(hl, e, e, e, root->nw), join(hl, e, e, root->ne, e),
+                        join(hl, e, root->sw, e, e), join(hl, root->se, e, e, e));
+    int64_t shift = (int64_t)1 << (root->level - 1);
+    hl->origin_x -= shift;
+    hl->origin_y -= shift;
+}
+
+static bool next_state(ca_lib_hashlife_t *hl, bool alive, int neighbours)
+{
+    return (alive ? hl->survival : hl->birth) >> neighbours & 1;
+}
+
+// Base case - advance the middle 2x2 cells of a level 2 node one generation
+static node_t *step_level_2(ca_lib_hashlife_t *hl, node_t *node)
+{
+    bool cells[4][4]; // [y][x]
+    node_t *quads[2][2] = {{node->nw, node->ne}, {node->sw, node->se}};
+    for (int qy = 0; qy < 2; qy++)
+    {
+        for (int qx = 0; qx < 2; qx++)
+        {
+            node_t *q = quads[qy][qx];
+            cells[qy * 2][qx * 2] = q->nw->population;
+            cells[qy * 2][qx * 2 + 1] = q->ne->population;
+            cells[qy * 2 + 1][qx * 2] = q->sw->population;
+            cells[qy * 2 + 1][qx * 2 + 1] = q->se->population;
+        }
+    }
+
+    node_t *next[2][2];
+    for (int y = 1; y <= 2; y++)
+    {
+        for (int x = 1; x <= 2; x++)
+        {
+            int neighbours = 0;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    neighbours += (dx || dy) && cells[y + dy][x + dx];
+                }
+            }
+            next[y - 1][x - 1] = next_state(hl, cells[y][x], neighbours) ? &hl->alive : &hl->dead;
+        }
+    }
+    return join(hl, next[0][0], next[0][1], next[1][0], next[1][1]);
+}
+
+// The centre (level - 1) of 'node' advanced 2^min('step_log2', level - 2) generations
+static node_t *successor(ca_lib_hashlife_t *hl, node_t *node, int step_log2)
+{
+    if (step_log2 > node->level - 2) { step_log2 = node->level - 2; }
+    if (node->population == 0) { return empty_node(hl, node->level - 1); }
+    if (node->result && node->result_step == step_log2) { return node->result; }
+
+    node_t *result;
+    if (node->level == 2)
+    {
+        result = step_level_2(hl, node);
+    }
+    else
+    {
+        node_t *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+
+        // Nine overlapping level - 1 nodes, each advanced
+        node_t *c[9];
+        c[0] = successor(hl, nw, step_log2);
+        c[1] = successor(hl, join(hl, nw->ne, ne->nw, nw->se, ne->sw), step_log2);
+        c[2] = successor(hl, ne, step_log2);
+        c[3] = successor(hl, join(hl, nw->sw, nw->se, sw->nw, sw->ne), step_log2);
+        c[4] = successor(hl, join(hl, nw->se, ne->sw, sw->ne, se->nw), step_log2);
+        c[5] = successor(hl, join(hl, ne->sw, ne->se, se->nw, se->ne), step_log2);
+        c[6] = successor(hl, sw, step_log2);
+        c[7] = successor(hl, join(hl, sw->ne, se->nw, sw->se, se->sw), step_log2);
+        c[8] = successor(hl, se, step_log2);
+
+        if (step_log2 < node->level - 2)
+        {
+            // The nine have already been advanced far enough - just stitch their centres together
+            result = join(hl, join(hl, c[0]->se, c[1]->sw, c[3]->ne, c[4]->nw),
+                              join(hl, c[1]->se, c[2]->sw, c[4]->ne, c[5]->nw),
+                              join(hl, c[3]->se, c[4]->sw, c[6]->ne, c[7]->nw),
+                              join(hl, c[4]->se, c[5]->sw, c[7]->ne, c[8]->nw));
+        }
+        else
+        {
+            // Advance four combinations of the nine once more
+            result = join(hl, successor(hl, join(hl, c[0], c[1], c[3], c[4]), step_log2),
+                              successor(hl, join(hl, c[1], c[2], c[4], c[5]), step_log2),
+                              successor(hl, join(hl, c[3], c[4], c[6], c[7]), step_log2),
+                              successor(hl, join(hl, c[4], c[5], c[7], c[8]), step_log2));
+        }
+    }
+
+    node->result = result;
+    node->result_step = step_log2;
+    return result;
+}
+
+// Returns 'node' with the cell at (x,y) relative to the node set to 'alive'
+static node_t *set_cell(ca_lib_hashlife_t *hl, node_t *node, int64_t x, int64_t y, bool alive)
+{
+    if (node->level == 0) { return alive ? &hl->alive : &hl->dead; }
+    int64_t half = (int64_t)1 << (node->level - 1);
+    node_t *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+    if (y < half)
+    {
+        if (x < half) { nw = set_cell(hl, nw, x, y, alive); }
+        else { ne = set_cell(hl, ne, x - half, y, alive); }
+    }
+    else
+    {
+        if (x < half) { sw = set_cell(hl, sw, x, y - half, alive); }
+        else { se = set_cell(hl, se, x - half, y - half, alive); }
+    }
+    return join(hl, nw, ne, sw, se);
+}
+
+// Builds the node covering the 2^level square at (x,y) of the imported region
+static node_t *import_node(ca_lib_hashlife_t *hl, int level, size_t x, size_t y, ca_lib_grid_t *grid, size_t gx, size_t gy, size_t width, size_t height, ca_lib_data_is_alive_t is_alive)
+{
+    if (x >= width || y >= height) { return empty_node(hl, level); }
+    if (level == 0)
+    {
+        return is_alive(ca_lib_get_cell_data(grid, gx + x, gy + y).ptr) ? &hl->alive : &hl->dead;
+    }
+    size_t half = (size_t)1 << (level - 1);
+    return join(hl, import_node(hl, level - 1, x, y, grid, gx, gy, width, height, is_alive),
+                    import_node(hl, level - 1, x + half, y, grid, gx, gy, width, height, is_alive),
+                    import_node(hl, level - 1, x, y + half, grid, gx, gy, width, height, is_alive),
+                    import_node(hl, level - 1, x + half, y + half, grid, gx, gy, width, height, is_alive));
+}
+
+// Inserts the live cells of 'node', whose north west cell is at universe (x,y), falling within the exported region
+static void export_node(node_t *node, int64_t x, int64_t y, ca_lib_grid_t *grid, size_t gx, size_t gy, int64_t width, int64_t height, size_t data_size, void *alive_data)
+{
+    int64_t side = (int64_t)1 << node->level;
+    if (node->population == 0 || x >= width || y >= height || x + side <= 0 || y + side <= 0) { return; }
+    if (node->level == 0)
+    {
+        ca_lib_insert_cell(grid, gx + x, gy + y, data_size, alive_data);
+        return;
+    }
+    int64_t half = side / 2;
+    export_node(node->nw, x, y, grid, gx, gy, width, height, data_size, alive_data);
+    export_node(node->ne, x + half, y, grid, gx, gy, width, height, data_size, alive_data);
+    export_node(node->sw, x, y + half, grid, gx, gy, width, height, data_size, alive_data);
+    export_node(node->se, x + half, y + half, grid, gx, gy, width, height, data_size, alive_data);
+}
+
+// Copies 'node' into the fresh node table - 'result' of the old nodes is reused to point at their copies
+static node_t *copy_node(ca_lib_hashlife_t *hl, node_t *node)
+{
+    if (node->level == 0) { return node; }
+    if (node->result) { return node->result; }
+    node_t *copy = join(hl, copy_node(hl, node->nw), copy_node(hl, node->ne), copy_node(hl, node->sw), copy_node(hl, node->se));
+    node->result = copy;
+    return copy;
+}
+
+// Drops every node (and memoised result) that isn't part of the current root
+static void collect_garbage(ca_lib_hashlife_t *hl)
+{
+    node_block_t *old_blocks = hl->blocks;
+    for (node_block_t *block = old_blocks; block; block = block->next)
+    {
+        for (size_t i = 0; i < block->used; i++)
+        {
+            block->nodes[i].result = NULL;
+        }
+    }
+
+    memset(hl->buckets, 0, hl->bucket_count * sizeof(node_t *));
+    memset(hl->empty, 0, sizeof(hl->empty));
+    hl->blocks = NULL;
+    hl->node_count = 0;
+    hl->root = copy_node(hl, hl->root);
+
+    while (old_blocks)
+    {
+        node_block_t *next = old_blocks->next;
+        free(old_blocks);
+        old_blocks = next;
+    }
+}
+
+static void reset_universe(ca_lib_hashlife_t *hl)
+{
+    hl->root = empty_node(hl, 3);
+    hl->origin_x = -4;
+    hl->origin_y = -4;
+    hl->generation = 0;
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_hashlife_t *ca_lib_create_hashlife(uint16_t birth, uint16_t survival)
+{
+    ca_lib_hashlife_t *hl = calloc(1, sizeof(ca_lib_hashlife_t));
+    hl->birth = birth & ~1u; // Births on 0 neighbours would fill the infinite universe
+    hl->survival = survival;
+    hl->dead.hash = mix(1);
+    hl->alive.hash = mix(2);
+    hl->alive.population = 1;
+    hl->bucket_count = 1024;
+    hl->buckets = calloc(hl->bucket_count, sizeof(node_t *));
+    reset_universe(hl);
+    return hl;
+}
+
+ca_lib_hashlife_t *ca_lib_destroy_hashlife(ca_lib_hashlife_t *hl)
+{
+    while (hl->blocks)
+    {
+        node_block_t *next = hl->blocks->next;
+        free(hl->blocks);
+        hl->blocks = next;
+    }
+    free(hl->buckets);
+    free(hl);
+    return NULL;
+}
+
+void ca_lib_hashlife_set_cell(ca_lib_hashlife_t *hl, int64_t x, int64_t y, bool alive)
+{
+    // Grow until (x,y) is inside the root
+    while (x < hl->origin_x || y < hl->origin_y ||
+           x >= hl->origin_x + ((int64_t)1 << hl->root->level) || y >= hl->origin_y + ((int64_t)1 << hl->root->level))
+    {
+        expand(hl);
+    }
+    hl->root = set_cell(hl, hl->root, x - hl->origin_x, y - hl->origin_y, alive);
+}
+
+bool ca_lib_hashlife_get_cell(ca_lib_hashlife_t *hl, int64_t x, int64_t y)
+{
+    node_t *node = hl->root;
+    x -= hl->origin_x;
+    y -= hl->origin_y;
+    if (x < 0 || y < 0 || x >= ((int64_t)1 << node->level) || y >= ((int64_t)1 << node->level)) { return false; }
+    while (node->level > 0 && node->population > 0)
+    {
+        int64_t half = (int64_t)1 << (node->level - 1);
+        if (y < half) { node = x < half ? node->nw : node->ne; }
+        else { node = x < half ? node->sw : node->se; y -= half; }
+        if (x >= half) { x -= half; }
+    }
+    return node->population > 0;
+}
+
+void ca_lib_hashlife_import(ca_lib_hashlife_t *hl, ca_lib_grid_t *grid, size_t x, size_t y, size_t width, size_t height, ca_lib_data_is_alive_t is_alive)
+{
+    int level = 3;
+    while (((size_t)1 << level) < width || ((size_t)1 << level) < height) { level++; }
+    reset_universe(hl);
+    hl->root = import_node(hl, level, 0, 0, grid, x, y, width, height, is_alive);
+    hl->origin_x = 0;
+    hl->origin_y = 0;
+}
+
+void ca_lib_hashlife_export(ca_lib_hashlife_t *hl, ca_lib_grid_t *grid, size_t x, size_t y, size_t width, size_t height, size_t data_size, void *alive_data)
+{
+    for (size_t ry = 0; ry < height; ry++)
+    {
+        for (size_t rx = 0; rx < width; rx++)
+        {
+            ca_lib_clear_cell(grid, x + rx, y + ry);
+        }
+    }
+    export_node(hl->root, hl->origin_x, hl->origin_y, grid, x, y, (int64_t)width, (int64_t)height, data_size, alive_data);
+}
+
+void ca_lib_hashlife_step(ca_lib_hashlife_t *hl, unsigned int step_log2)
+{
+    if (step_log2 > MAX_LEVEL - 4) { step_log2 = MAX_LEVEL - 4; }
+
+    // The pattern must sit in the middle of the root with a margin of at least 2^'step_log2' cells - the
+    // furthest it can spread in that many generations
+    while (hl->root->level < (int)step_log2 + 3 || !is_padded(hl->root))
+    {
+        expand(hl);
+    }
+    int64_t quarter = (int64_t)1 << (hl->root->level - 2);
+    hl->root = successor(hl, hl->root, step_log2);
+    hl->origin_x += quarter;
+    hl->origin_y += quarter;
+    hl->generation += (uint64_t)1 << step_log2;
+
+    if (hl->node_count > CA_LIB_HASHLIFE_MAX_NODES) { collect_garbage(hl); }
+}
+
+uint64_t ca_lib_hashlife_generation(ca_lib_hashlife_t *hl)
+{
+    return hl->generation;
+}
+
+uint64_t ca_lib_hashlife_population(ca_lib_hashlife_t *hl)
+{
+    return hl->root->population;
+}
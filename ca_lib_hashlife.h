@@ -0,0 +1,80 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "ca_lib.h"
+
+// ca-lib HashLife - an unbounded Life-like universe stored as a quadtree of canonical, memoised nodes
+
+// Nodes are garbage collected after a step once more than this many exist
+#define CA_LIB_HASHLIFE_MAX_NODES (1 << 22)
+
+typedef struct hashlife ca_lib_hashlife_t;
+
+/// @brief Decides whether a cell is alive based on 'data_ptr' (which may be NULL) when importing from a grid
+typedef bool(*ca_lib_data_is_alive_t)(void *data_ptr);
+
+/*----FUNCTION HEADERS----*/
+
+/// @brief Creates an empty universe ruled by the Life-like rule given by 'birth' and 'survival' (see 'ca_lib_bit_grid_step')
+/// @param birth a dead cell with n live neighbours becomes alive if bit n is set - bit 0 may not be set
+/// @param survival a live cell with n live neighbours stays alive if bit n is set
+/// @return the allocated universe
+ca_lib_hashlife_t *ca_lib_create_hashlife(uint16_t birth, uint16_t survival);
+
+/// @brief Frees the universe and all of its nodes and returns NULL
+/// @param hl
+/// @return NULL
+ca_lib_hashlife_t *ca_lib_destroy_hashlife(ca_lib_hashlife_t *hl);
+
+/// @brief Sets the cell at (x,y) to alive or dead - the universe grows as needed
+/// @param hl
+/// @param x
+/// @param y
+/// @param alive
+void ca_lib_hashlife_set_cell(ca_lib_hashlife_t *hl, int64_t x, int64_t y, bool alive);
+
+/// @brief Checks whether the cell at (x,y) is alive
+/// @param hl
+/// @param x
+/// @param y
+/// @return true if alive, otherwise false
+bool ca_lib_hashlife_get_cell(ca_lib_hashlife_t *hl, int64_t x, int64_t y);
+
+/// @brief Replaces the universe with the 'width' by 'height' region of 'grid' starting at (x,y)
+/// The region's cell (x,y) ends up at (0,0) in the universe and the generation count is reset.
+/// @param hl
+/// @param grid the grid to import from
+/// @param x
+/// @param y
+/// @param width
+/// @param height
+/// @param is_alive decides which cells are alive
+void ca_lib_hashlife_import(ca_lib_hashlife_t *hl, ca_lib_grid_t *grid, size_t x, size_t y, size_t width, size_t height, ca_lib_data_is_alive_t is_alive);
+
+/// @brief Writes the 'width' by 'height' region of the universe starting at (0,0) to 'grid' starting at (x,y)
+/// Live cells get 'alive_data' inserted, dead cells are cleared.
+/// @param hl
+/// @param grid the grid to export to
+/// @param x
+/// @param y
+/// @param width
+/// @param height
+/// @param data_size size of 'alive_data' in bytes
+/// @param alive_data the data inserted into live cells
+void ca_lib_hashlife_export(ca_lib_hashlife_t *hl, ca_lib_grid_t *grid, size_t x, size_t y, size_t width, size_t height, size_t data_size, void *alive_data);
+
+/// @brief Advances the universe 2^'step_log2' generations
+/// @param hl
+/// @param step_log2
+void ca_lib_hashlife_step(ca_lib_hashlife_t *hl, unsigned int step_log2);
+
+/// @brief Number of generations the universe has been advanced since it was created or imported
+/// @param hl
+/// @return the generation
+uint64_t ca_lib_hashlife_generation(ca_lib_hashlife_t *hl);
+
+/// @brief Counts the live cells of the universe in O(1)
+/// @param hl
+/// @return the number of live cells
+uint64_t ca_lib_hashlife_population(ca_lib_hashlife_t *hl);
@@ -0,0 +1,199 @@
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdalign.h>
+#include <pthread.h>
+#include "ca_lib_intern.h"
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+// Lies right in front of every interned payload
+struct interned
+{
+    ca_lib_intern_table_t *table;
+    struct interned *next; // Next entry in the same bucket
+    struct interned *next_by_address; // Next entry in the same address bucket
+    size_t refcount;
+    size_t size;
+    uint64_t hash;
+    alignas(max_align_t) unsigned char bytes[];
+};
+typedef struct interned interned_t;
+
+struct intern_table
+{
+    pthread_mutex_t lock;
+    interned_t **buckets;
+    interned_t **address_buckets; // The same entries by payload address - lets 'ca_lib_intern_owns' answer without touching the payload
+    size_t bucket_count; // Always a power of 2 - or 0 before the first payload
+    size_t count;
+};
+
+// Serves 'ca_lib_alloc_interned_ptr' outside of any grid - lives as long as the process
+static ca_lib_intern_table_t shared_table = {PTHREAD_MUTEX_INITIALIZER, NULL, NULL, 0, 0};
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+// FNV-1a
+static uint64_t hash_bytes(const unsigned char *bytes, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t hash_address(const void *data_ptr)
+{
+    uint64_t z = (uintptr_t)data_ptr;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static interned_t **address_bucket(interned_t **address_buckets, size_t bucket_count, const void *data_ptr)
+{
+    return &address_buckets[hash_address(data_ptr) & (bucket_count - 1)];
+}
+
+static interned_t *entry_of(void *data_ptr)
+{
+    return (interned_t *)((unsigned char *)data_ptr - offsetof(interned_t, bytes));
+}
+
+// Double the number of buckets once the table is 3/4 full - the caller holds the lock
+static void grow(ca_lib_intern_table_t *table)
+{
+    size_t bucket_count = table->bucket_count ? table->bucket_count * 2 : 16;
+    interned_t **buckets = calloc(bucket_count, sizeof(interned_t *));
+    interned_t **address_buckets = calloc(bucket_count, sizeof(interned_t *));
+    for (size_t b = 0; b < table->bucket_count; b++)
+    {
+        interned_t *entry = table->buckets[b];
+        while (entry)
+        {
+            interned_t *next = entry->next;
+            interned_t **bucket = &buckets[entry->hash & (bucket_count - 1)];
+            entry->next = *bucket;
+            *bucket = entry;
+            bucket = address_bucket(address_buckets, bucket_count, entry->bytes);
+            entry->next_by_address = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+    free(table->buckets);
+    free(table->address_buckets);
+    table->buckets = buckets;
+    table->address_buckets = address_buckets;
+    table->bucket_count = bucket_count;
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_intern_table_t *ca_lib_create_intern_table(void)
+{
+    ca_lib_intern_table_t *table = calloc(1, sizeof(ca_lib_intern_table_t));
+    pthread_mutex_init(&table->lock, NULL);
+    return table;
+}
+
+ca_lib_intern_table_t *ca_lib_shared_intern_table(void)
+{
+    return &shared_table;
+}
+
+ca_lib_intern_table_t *ca_lib_destroy_intern_table(ca_lib_intern_table_t *table)
+{
+    for (size_t b = 0; b < table->bucket_count; b++)
+    {
+        interned_t *entry = table->buckets[b];
+        while (entry)
+        {
+            interned_t *next = entry->next;
+            free(entry);
+            entry = next;
+        }
+    }
+    free(table->buckets);
+    free(table->address_buckets);
+    pthread_mutex_destroy(&table->lock);
+    free(table);
+    return NULL;
+}
+
+void *ca_lib_intern(ca_lib_intern_table_t *table, void *data_ptr, size_t data_size)
+{
+    uint64_t hash = hash_bytes(data_ptr, data_size);
+    pthread_mutex_lock(&table->lock);
+
+    if (table->bucket_count)
+    {
+        for (interned_t *entry = table->buckets[hash & (table->bucket_count - 1)]; entry; entry = entry->next)
+        {
+            if (entry->hash != hash || entry->size != data_size) { continue; }
+            if (data_size > 0 && memcmp(entry->bytes, data_ptr, data_size) != 0) { continue; }
+            entry->refcount++;
+            pthread_mutex_unlock(&table->lock);
+            return entry->bytes;
+        }
+    }
+
+    if (table->count + 1 > table->bucket_count / 4 * 3) { grow(table); }
+    interned_t *entry = calloc(1, sizeof(interned_t) + data_size);
+    entry->table = table;
+    entry->refcount = 1;
+    entry->size = data_size;
+    entry->hash = hash;
+    if (data_size > 0) { memcpy(entry->bytes, data_ptr, data_size); }
+    interned_t **bucket = &table->buckets[hash & (table->bucket_count - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    bucket = address_bucket(table->address_buckets, table->bucket_count, entry->bytes);
+    entry->next_by_address = *bucket;
+    *bucket = entry;
+    table->count++;
+
+    pthread_mutex_unlock(&table->lock);
+    return entry->bytes;
+}
+
+void ca_lib_release_interned(void *data_ptr)
+{
+    if (!data_ptr) { return; }
+    interned_t *entry = entry_of(data_ptr);
+    ca_lib_intern_table_t *table = entry->table;
+
+    pthread_mutex_lock(&table->lock);
+    if (--entry->refcount == 0)
+    {
+        interned_t **link = &table->buckets[entry->hash & (table->bucket_count - 1)];
+        while (*link != entry) { link = &(*link)->next; }
+        *link = entry->next;
+        link = address_bucket(table->address_buckets, table->bucket_count, data_ptr);
+        while (*link != entry) { link = &(*link)->next_by_address; }
+        *link = entry->next_by_address;
+        table->count--;
+        free(entry);
+    }
+    pthread_mutex_unlock(&table->lock);
+}
+
+// Looked up by address rather than read from an entry header, since 'data_ptr' may come from anywhere
+bool ca_lib_intern_owns(ca_lib_intern_table_t *table, void *data_ptr)
+{
+    if (!data_ptr) { return false; }
+    bool owns = false;
+    pthread_mutex_lock(&table->lock);
+    if (table->bucket_count)
+    {
+        interned_t *entry = *address_bucket(table->address_buckets, table->bucket_count, data_ptr);
+        for (; entry && !owns; entry = entry->next_by_address) { owns = entry->bytes == (unsigned char *)data_ptr; }
+    }
+    pthread_mutex_unlock(&table->lock);
+    return owns;
+}
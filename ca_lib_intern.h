@@ -0,0 +1,38 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+
+// ca-lib intern - refcounted table of immutable payloads behind 'ca_lib_alloc_interned_ptr' / 'ca_lib_free_interned_ptr'
+// Not part of the user-reachable interface, grids created with the interned pair all use the shared table
+
+typedef struct intern_table ca_lib_intern_table_t;
+
+/// @brief Creates an empty table
+/// @return the allocated table
+ca_lib_intern_table_t *ca_lib_create_intern_table(void);
+
+/// @brief The process-wide table used when the interned allocator pair is called directly
+/// @return the shared table - never destroyed
+ca_lib_intern_table_t *ca_lib_shared_intern_table(void);
+
+/// @brief Frees the table and every payload in it, whatever their reference counts - all of them become invalid
+/// @param table
+/// @return NULL
+ca_lib_intern_table_t *ca_lib_destroy_intern_table(ca_lib_intern_table_t *table);
+
+/// @brief Returns the table's payload with the same bytes as 'data_ptr', adding it if there is none - thread safe
+/// @param table
+/// @param data_ptr may only be NULL if 'data_size' is 0
+/// @param data_size
+/// @return the shared payload, with its reference count increased by one
+void *ca_lib_intern(ca_lib_intern_table_t *table, void *data_ptr, size_t data_size);
+
+/// @brief Drops a reference to an interned payload, freeing it when none are left - thread safe
+/// @param data_ptr a payload from any table
+void ca_lib_release_interned(void *data_ptr);
+
+/// @brief Checks whether 'data_ptr' belongs to 'table' - thread safe
+/// @param table
+/// @param data_ptr any pointer, or NULL - never dereferenced
+/// @return true if it does, otherwise false
+bool ca_lib_intern_owns(ca_lib_intern_table_t *table, void *data_ptr);
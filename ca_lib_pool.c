@@ -0,0 +1,237 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "ca_lib_pool.h"
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+// Room left at the start of every slab for its header - keeps the payloads 64 byte aligned
+#define SLAB_HEADER_SIZE 64
+
+// Lies at the start of every slab
+struct slab
+{
+    ca_lib_pool_t *pool; // The pool the slab's payloads are returned to
+    size_t size_class; // Index of the slab's size class, 'CA_LIB_POOL_CLASS_COUNT' for a single large payload
+    struct slab *prev; // All slabs of the pool
+    struct slab *next;
+};
+typedef struct slab slab_t;
+
+// A free payload links to the next free payload of its size class through its own first bytes
+struct free_payload
+{
+    struct free_payload *next;
+};
+typedef struct free_payload free_payload_t;
+
+// The addresses ['start', 'end') of one of the pool's slabs
+struct slab_range
+{
+    uintptr_t start;
+    uintptr_t end;
+};
+typedef struct slab_range slab_range_t;
+
+struct pool
+{
+    pthread_mutex_t lock;
+    slab_t *slabs;
+    free_payload_t *free_lists[CA_LIB_POOL_CLASS_COUNT];
+    slab_range_t *ranges; // Every slab, sorted by address - lets 'ca_lib_pool_owns' answer without touching the payload
+    size_t range_count;
+    size_t range_capacity;
+};
+
+// Serves 'ca_lib_alloc_pooled_ptr' outside of any grid - lives as long as the process
+static ca_lib_pool_t shared_pool = {PTHREAD_MUTEX_INITIALIZER, NULL, {NULL}, NULL, 0, 0};
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+static size_t class_size(size_t size_class)
+{
+    return (size_t)8 << size_class;
+}
+
+static size_t size_class_of(size_t size)
+{
+    size_t size_class = 0;
+    while (size_class < CA_LIB_POOL_CLASS_COUNT && class_size(size_class) < size)
+    {
+        size_class++;
+    }
+    return size_class;
+}
+
+static slab_t *slab_of(void *data_ptr)
+{
+    return (slab_t *)((uintptr_t)data_ptr & ~(uintptr_t)(CA_LIB_POOL_SLAB_SIZE - 1));
+}
+
+// Index of the first range starting above 'address' - the caller holds the lock
+static size_t range_after(ca_lib_pool_t *pool, uintptr_t address)
+{
+    size_t low = 0, high = pool->range_count;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (pool->ranges[mid].start <= address) { low = mid + 1; }
+        else { high = mid; }
+    }
+    return low;
+}
+
+// The caller holds the lock
+static bool add_range(ca_lib_pool_t *pool, uintptr_t start, size_t size)
+{
+    if (pool->range_count == pool->range_capacity)
+    {
+        size_t capacity = pool->range_capacity ? pool->range_capacity * 2 : 16;
+        slab_range_t *ranges = realloc(pool->ranges, capacity * sizeof(slab_range_t));
+        if (!ranges) { return false; }
+        pool->ranges = ranges;
+        pool->range_capacity = capacity;
+    }
+    size_t i = range_after(pool, start);
+    memmove(&pool->ranges[i + 1], &pool->ranges[i], (pool->range_count - i) * sizeof(slab_range_t));
+    pool->ranges[i] = (slab_range_t){start, start + size};
+    pool->range_count++;
+    return true;
+}
+
+// The caller holds the lock
+static void remove_range(ca_lib_pool_t *pool, uintptr_t start)
+{
+    size_t i = range_after(pool, start) - 1;
+    memmove(&pool->ranges[i], &pool->ranges[i + 1], (pool->range_count - i - 1) * sizeof(slab_range_t));
+    pool->range_count--;
+}
+
+// Allocate a slab of 'size' bytes (a multiple of the slab size) and link it into the pool - the caller holds the lock
+static slab_t *new_slab(ca_lib_pool_t *pool, size_t size_class, size_t size)
+{
+    slab_t *slab = aligned_alloc(CA_LIB_POOL_SLAB_SIZE, size);
+    if (!slab) { return NULL; }
+    if (!add_range(pool, (uintptr_t)slab, size))
+    {
+        free(slab);
+        return NULL;
+    }
+    slab->pool = pool;
+    slab->size_class = size_class;
+    slab->prev = NULL;
+    slab->next = pool->slabs;
+    if (pool->slabs) { pool->slabs->prev = slab; }
+    pool->slabs = slab;
+    return slab;
+}
+
+// Carve a new slab into payloads of 'size_class' and put them on its free list - the caller holds the lock
+static void refill(ca_lib_pool_t *pool, size_t size_class)
+{
+    slab_t *slab = new_slab(pool, size_class, CA_LIB_POOL_SLAB_SIZE);
+    if (!slab) { return; }
+    size_t size = class_size(size_class);
+    unsigned char *payload = (unsigned char *)slab + SLAB_HEADER_SIZE;
+    unsigned char *end = (unsigned char *)slab + CA_LIB_POOL_SLAB_SIZE;
+    for (; payload + size <= end; payload += size)
+    {
+        free_payload_t *free_payload = (free_payload_t *)payload;
+        free_payload->next = pool->free_lists[size_class];
+        pool->free_lists[size_class] = free_payload;
+    }
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_pool_t *ca_lib_create_pool(void)
+{
+    ca_lib_pool_t *pool = calloc(1, sizeof(ca_lib_pool_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    return pool;
+}
+
+ca_lib_pool_t *ca_lib_shared_pool(void)
+{
+    return &shared_pool;
+}
+
+ca_lib_pool_t *ca_lib_destroy_pool(ca_lib_pool_t *pool)
+{
+    slab_t *slab = pool->slabs;
+    while (slab)
+    {
+        slab_t *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(pool->ranges);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+    return NULL;
+}
+
+void *ca_lib_pool_alloc(ca_lib_pool_t *pool, void *data_ptr, size_t data_size)
+{
+    size_t size_class = size_class_of(data_size);
+    void *payload = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (size_class == CA_LIB_POOL_CLASS_COUNT)
+    {
+        size_t size = (SLAB_HEADER_SIZE + data_size + CA_LIB_POOL_SLAB_SIZE - 1) & ~(CA_LIB_POOL_SLAB_SIZE - 1);
+        slab_t *slab = new_slab(pool, size_class, size);
+        payload = slab ? (unsigned char *)slab + SLAB_HEADER_SIZE : NULL;
+    }
+    else
+    {
+        if (!pool->free_lists[size_class]) { refill(pool, size_class); }
+        payload = pool->free_lists[size_class];
+        if (payload) { pool->free_lists[size_class] = pool->free_lists[size_class]->next; }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!payload) { return NULL; }
+    if (data_ptr) { memcpy(payload, data_ptr, data_size); }
+    else { memset(payload, 0, data_size); }
+    return payload;
+}
+
+void ca_lib_pool_free(void *data_ptr)
+{
+    if (!data_ptr) { return; }
+    slab_t *slab = slab_of(data_ptr);
+    ca_lib_pool_t *pool = slab->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    if (slab->size_class == CA_LIB_POOL_CLASS_COUNT)
+    {
+        // Large payloads have their slab to themselves - unlink and release it
+        if (slab->prev) { slab->prev->next = slab->next; }
+        else { pool->slabs = slab->next; }
+        if (slab->next) { slab->next->prev = slab->prev; }
+        remove_range(pool, (uintptr_t)slab);
+        free(slab);
+    }
+    else
+    {
+        free_payload_t *free_payload = data_ptr;
+        free_payload->next = pool->free_lists[slab->size_class];
+        pool->free_lists[slab->size_class] = free_payload;
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Looked up among the pool's slabs rather than read from a slab header, since 'data_ptr' may come from anywhere
+bool ca_lib_pool_owns(ca_lib_pool_t *pool, void *data_ptr)
+{
+    if (!data_ptr) { return false; }
+    uintptr_t address = (uintptr_t)data_ptr;
+    pthread_mutex_lock(&pool->lock);
+    size_t i = range_after(pool, address);
+    bool owns = i > 0 && address < pool->ranges[i - 1].end;
+    pthread_mutex_unlock(&pool->lock);
+    return owns;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+
+// ca-lib pool - size-class slab allocator behind 'ca_lib_alloc_pooled_ptr' / 'ca_lib_free_pooled_ptr'
+// Not part of the user-reachable interface, grids created with the pooled pair get a pool of their own
+
+// Slabs are this large and aligned to their size, so any payload finds its slab's header by rounding its address down
+#define CA_LIB_POOL_SLAB_SIZE ((size_t)1 << 16)
+
+// Payloads of up to 8 << ('CA_LIB_POOL_CLASS_COUNT' - 1) bytes are carved out of shared slabs, larger ones get a slab to themselves
+#define CA_LIB_POOL_CLASS_COUNT 10
+
+typedef struct pool ca_lib_pool_t;
+
+/// @brief Creates an empty pool
+/// @return the allocated pool
+ca_lib_pool_t *ca_lib_create_pool(void);
+
+/// @brief The process-wide pool used when the pooled allocator pair is called directly
+/// @return the shared pool - never destroyed
+ca_lib_pool_t *ca_lib_shared_pool(void);
+
+/// @brief Releases every slab of the pool at once - all payloads allocated from it become invalid
+/// @param pool
+/// @return NULL
+ca_lib_pool_t *ca_lib_destroy_pool(ca_lib_pool_t *pool);
+
+/// @brief Allocates 'data_size' bytes from the pool and copies over 'data_ptr' (zeroed if NULL) - thread safe
+/// @param pool
+/// @param data_ptr
+/// @param data_size
+/// @return the payload
+void *ca_lib_pool_alloc(ca_lib_pool_t *pool, void *data_ptr, size_t data_size);
+
+/// @brief Returns a payload to the pool it was allocated from - thread safe
+/// @param data_ptr a payload from any pool
+void ca_lib_pool_free(void *data_ptr);
+
+/// @brief Checks whether 'data_ptr' was allocated from 'pool' - thread safe
+/// @param pool
+/// @param data_ptr any pointer, or NULL - never dereferenced
+/// @return true if it was, otherwise false
+bool ca_lib_pool_owns(ca_lib_pool_t *pool, void *data_ptr);
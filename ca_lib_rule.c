@@ -0,0 +1,203 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include "ca_lib_rule.h"
+#include "ca_lib_struct_def.h"
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+struct rule
+{
+    uint16_t birth; // Bit n set - a dead cell with n live neighbours is born
+    uint16_t survival; // Bit n set - a live cell with n live neighbours survives
+    size_t state_count; // 2 for Life-like rules, more for Generations rules
+    uint8_t table[]; // Next state of state s with n live neighbours at [s * 9 + n]
+};
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+// Parses a string of neighbour counts ("236") up until 'end' into a mask - returns false on anything but 0-8
+static bool parse_counts(const char *str, const char *end, uint16_t *mask)
+{
+    for (; str < end; str++)
+    {
+        if (*str < '0' || *str > '8') { return false; }
+        *mask |= 1u << (*str - '0');
+    }
+    return true;
+}
+
+static bool parse_state_count(const char *str, const char *end, size_t *state_count)
+{
+    if (str == end) { return false; }
+    size_t count = 0;
+    for (; str < end; str++)
+    {
+        if (!isdigit((unsigned char)*str)) { return false; }
+        count = count * 10 + (*str - '0');
+        if (count > 256) { return false; }
+    }
+    *state_count = count;
+    return count >= 2;
+}
+
+static void fill_table(ca_lib_rule_t *rule)
+{
+    for (int n = 0; n <= 8; n++)
+    {
+        rule->table[0 * 9 + n] = rule->birth >> n & 1 ? 1 : 0;
+        // A live cell that doesn't survive starts dying - or dies at once in a 2-state rule
+        rule->table[1 * 9 + n] = rule->survival >> n & 1 ? 1 : (rule->state_count > 2 ? 2 : 0);
+        for (size_t s = 2; s < rule->state_count; s++)
+        {
+            rule->table[s * 9 + n] = s + 1 < rule->state_count ? s + 1 : 0;
+        }
+    }
+}
+
+// Count the live neighbours of cell 'x' - the rows are padded with a dead cell on each side
+static inline int live_neighbours(const uint8_t *up, const uint8_t *mid, const uint8_t *down, size_t x)
+{
+    return up[x - 1] + up[x] + up[x + 1] + mid[x - 1] + mid[x + 1] + down[x - 1] + down[x] + down[x + 1];
+}
+
+static inline uint8_t is_live(const void *ptr)
+{
+    return ptr && *(const uint8_t *)ptr == 1;
+}
+
+// Store 1 for every cell of row 'y' that is alive (state 1), 0 otherwise - the padding comes from the row's halo cells,
+// and 'y' may be -1 or 'height' to load a halo row, so the cells outside of the grid follow its boundary
+static void load_live_row(ca_lib_grid_t *grid, long y, uint8_t *live)
+{
+    const cell_t *cells = &grid->cells[(size_t)(y + 1) * grid->stride];
+    live[0] = is_live(cells[0].ptr);
+    live[grid->width + 1] = is_live(cells[grid->width + 1].ptr);
+    if (y < 0 || (size_t)y >= grid->height)
+    {
+        for (size_t x = 0; x < grid->width; x++) { live[x + 1] = is_live(cells[x + 1].ptr); }
+        return;
+    }
+    const uint8_t *row = grid->payloads + (size_t)y * grid->width;
+    for (size_t x = 0; x < grid->width; x++)
+    {
+        live[x + 1] = row[x] == 1;
+    }
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_rule_t *ca_lib_compile_rule(const char *rulestring)
+{
+    uint16_t birth = 0;
+    uint16_t survival = 0;
+    size_t state_count = 2;
+    bool seen_birth = false, seen_survival = false, seen_count = false; // Every section may only be given once
+    if (*rulestring == '\0') { return NULL; }
+
+    const char *part = rulestring;
+    for (int index = 0; ; index++)
+    {
+        const char *end = strchr(part, '/');
+        if (!end) { end = part + strlen(part); }
+
+        // Unlabeled parts are given by their position - S/B/C
+        char label = tolower((unsigned char)*part);
+        const char *counts = part + 1;
+        if (label != 'b' && label != 's' && label != 'c' && label != 'g')
+        {
+            label = index == 0 ? 's' : index == 1 ? 'b' : index == 2 ? 'c' : '\0';
+            counts = part;
+        }
+
+        bool valid = false;
+        if (label == 'b' && !seen_birth) { valid = seen_birth = parse_counts(counts, end, &birth); }
+        else if (label == 's' && !seen_survival) { valid = seen_survival = parse_counts(counts, end, &survival); }
+        else if ((label == 'c' || label == 'g') && !seen_count) { valid = seen_count = parse_state_count(counts, end, &state_count); }
+
+        if (!valid) { return NULL; }
+        if (*end == '\0') { break; }
+        part = end + 1;
+    }
+
+    ca_lib_rule_t *rule = calloc(1, sizeof(ca_lib_rule_t) + state_count * 9);
+    rule->birth = birth;
+    rule->survival = survival;
+    rule->state_count = state_count;
+    fill_table(rule);
+    return rule;
+}
+
+ca_lib_rule_t *ca_lib_destroy_rule(ca_lib_rule_t *rule)
+{
+    free(rule);
+    return NULL;
+}
+
+size_t ca_lib_rule_state_count(ca_lib_rule_t *rule)
+{
+    return rule->state_count;
+}
+
+uint8_t ca_lib_rule_next_state(ca_lib_rule_t *rule, uint8_t state, int neighbours)
+{
+    if (state >= rule->state_count || neighbours < 0 || neighbours > 8) { return 0; }
+    return rule->table[state * 9 + neighbours];
+}
+
+uint16_t ca_lib_rule_birth_mask(ca_lib_rule_t *rule)
+{
+    return rule->birth;
+}
+
+uint16_t ca_lib_rule_survival_mask(ca_lib_rule_t *rule)
+{
+    return rule->survival;
+}
+
+// Streams through the rows keeping the live-ness of the previous, current and next row of the OLD generation
+// in three padded rows, so the grid itself can be updated in place
+void ca_lib_simulate_rule(ca_lib_grid_t *grid, ca_lib_rule_t *rule)
+{
+    if (grid->cell_size != 1) { return; }
+    ca_lib_begin_generation(grid);
+
+    size_t width = grid->width;
+    if (!grid->live_rows) { grid->live_rows = malloc(4 * (width + 2)); }
+    uint8_t *up = grid->live_rows;
+    uint8_t *mid = up + (width + 2);
+    uint8_t *down = up + 2 * (width + 2);
+    uint8_t *below = up + 3 * (width + 2);
+    // Halo rows may alias rows that are updated in place (periodic or reflective boundary), so both are loaded up front
+    load_live_row(grid, -1, up);
+    load_live_row(grid, grid->height, below);
+    if (grid->height > 0) { load_live_row(grid, 0, mid); }
+
+    for (size_t y = 0; y < grid->height; y++)
+    {
+        uint8_t *row = grid->payloads + y * width;
+        if (y + 1 < grid->height) { load_live_row(grid, y + 1, down); }
+        else { memcpy(down, below, width + 2); }
+
+        atomic_bool *dirty_row = &grid->dirty_chunks[(y / CA_LIB_CHUNK_SIZE) * grid->chunks_x];
+        for (size_t x = 0; x < width; x++)
+        {
+            uint8_t state = row[x] < rule->state_count ? row[x] : 0;
+            uint8_t next = rule->table[state * 9 + live_neighbours(up, mid, down, x + 1)];
+            if (next != row[x])
+            {
+                row[x] = next;
+                atomic_store_explicit(&dirty_row[x / CA_LIB_CHUNK_SIZE], true, memory_order_relaxed); // For 'ca_lib_simulate_active'
+                ca_lib_track_cell_change(grid, x, y);
+            }
+        }
+
+        // Rotate the rows - the old 'up' is reused for the next 'down'
+        uint8_t *tmp = up;
+        up = mid;
+        mid = down;
+        down = tmp;
+    }
+}
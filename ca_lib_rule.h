@@ -0,0 +1,53 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "ca_lib.h"
+
+// ca-lib rules - Life-like and Generations rules compiled from rulestrings into lookup tables
+
+typedef struct rule ca_lib_rule_t;
+
+/*----FUNCTION HEADERS----*/
+
+/// @brief Compiles a rulestring into a lookup table
+/// Accepts B/S notation ("B3/S23", "B36/S23"), S/B notation ("23/3") and Generations rules with a state count
+/// ("B2/S/C3", "345/2/4"). State 0 is dead, 1 is alive and 2 up to count - 1 are dying. Every section may be given once.
+/// @param rulestring the rule to compile
+/// @return the compiled rule, or NULL if 'rulestring' is invalid
+ca_lib_rule_t *ca_lib_compile_rule(const char *rulestring);
+
+/// @brief Frees the given rule and returns NULL
+/// @param rule
+/// @return NULL
+ca_lib_rule_t *ca_lib_destroy_rule(ca_lib_rule_t *rule);
+
+/// @brief Number of states of the rule - 2 for Life-like rules
+/// @param rule
+/// @return the number of states
+size_t ca_lib_rule_state_count(ca_lib_rule_t *rule);
+
+/// @brief Looks up the next state of a cell in 'state' with 'neighbours' live (state 1) neighbours
+/// @param rule
+/// @param state 0 up to the rule's state count - 1
+/// @param neighbours 0-8
+/// @return the next state
+uint8_t ca_lib_rule_next_state(ca_lib_rule_t *rule, uint8_t state, int neighbours);
+
+/// @brief Birth mask of the rule - bit n is set if a dead cell with n live neighbours is born (see 'ca_lib_bit_grid_step')
+/// @param rule
+/// @return the birth mask
+uint16_t ca_lib_rule_birth_mask(ca_lib_rule_t *rule);
+
+/// @brief Survival mask of the rule - bit n is set if a live cell with n live neighbours stays alive (see 'ca_lib_bit_grid_step')
+/// @param rule
+/// @return the survival mask
+uint16_t ca_lib_rule_survival_mask(ca_lib_rule_t *rule);
+
+/// @brief Advances a typed grid of 1-byte states one generation with the compiled rule
+/// Every neighbourhood is read once per cell from the previous generation, cells outside of the grid follow its boundary
+/// (see 'ca_lib_set_boundary') - dead unless set otherwise.
+/// Does nothing unless 'grid' was created with 'ca_lib_create_typed_grid' and a cell size of 1.
+/// @param grid the grid to be operated on
+/// @param rule the compiled rule
+void ca_lib_simulate_rule(ca_lib_grid_t *grid, ca_lib_rule_t *rule);
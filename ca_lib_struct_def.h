@@ -0,0 +1,103 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ca_lib.h"
+#include "ca_lib_pool.h"
+#include "ca_lib_intern.h"
+#include "ca_lib_arena.h"
+#include "ca_lib_threads.h"
+
+// Definitions of the grid shared between the ca-lib modules - not part of the user-reachable interface
+
+// 16 bytes - the coordinates follow from the cell's index, the engines hand the rules a 'data_t' built on the stack
+struct cell_struct
+{
+    void *ptr;
+    uint32_t size;
+    unsigned int stamp; // Last step the cell's data was simulated in - moves along with the data
+};
+
+typedef struct cell_struct cell_t;
+
+// Class of the cells that aren't counted - empty, or classified outside of the grid's classes
+#define CA_LIB_UNCOUNTED UINT32_MAX
+
+// No cell wants to move to the cell, see 'winners'
+#define CA_LIB_NO_WINNER SIZE_MAX
+
+struct grid
+{
+    void *meta_data; // data pertaining to the whole grid, muste be alloc:ed/freed by the user
+    size_t width; // Width of the simulation
+    size_t height; // Height of the simulation
+    ca_lib_data_alloc_function_t alloc_func; // A 'ca_lib_data_alloc_function_t' that allocates the cells' data
+    ca_lib_data_free_function_t free_func; // A 'ca_lib_data_free_function_t' that frees the cells' data
+    ca_lib_pool_t *pool; // The grid's own pool if it was created with the pooled allocator pair, otherwise NULL
+    ca_lib_intern_table_t *interns; // The shared table if the grid was created with the interned allocator pair, otherwise NULL
+    ca_lib_arena_t *arena; // The grid's own arena if it was created with the arena allocator pair, otherwise NULL
+    size_t cell_size; // Size of each inline payload in bytes - 0 unless the grid is typed
+    unsigned char *payloads; // Typed grids: 'width' * 'height' inline payloads stored right after 'cells'
+    unsigned char *back; // Set by 'ca_lib_enable_double_buffer' - as large as 'payloads', receives the next generation
+    struct tile_phase *phase_tiles; // 'ca_lib_simulate_phased': its jobs, planned by the first step and whenever the tile size changes
+    size_t phase_starts[5]; // The tiles of phase p are ['phase_starts[p]', 'phase_starts[p + 1]') of 'phase_tiles'
+    struct row_band *row_bands; // 'ca_lib_simulate_unabstract_parallel': its jobs, planned by the first step and whenever the thread count changes
+    size_t row_band_count;
+    struct row_span_band *row_span_bands; // 'ca_lib_simulate_rows': its jobs, planned by the first step and whenever the thread count changes
+    size_t row_span_band_count;
+    unsigned char *row_span_buffers; // 'ca_lib_simulate_rows': two edge rows per band and three scratch rows per worker thread
+    struct sync_band *sync_bands; // 'ca_lib_simulate_sync': its jobs, planned along with 'back' and whenever the thread count changes
+    size_t sync_band_count;
+    void **neighbourhood_ptrs; // The neighbourhood engines: one neighbourhood per worker thread, grown to the largest radius used
+    size_t neighbourhood_ptr_count;
+    unsigned char *blocked_rows; // 'ca_lib_simulate_rows_blocked': results of the tile rows not yet copied back - kept between steps
+    size_t blocked_rows_bytes;
+    unsigned char *blocked_planes; // 'ca_lib_simulate_rows_blocked': two planes per worker thread for a tile and its margin
+    size_t blocked_planes_bytes;
+    uint8_t *live_rows; // 'ca_lib_simulate_rule': four padded rows of live-ness - allocated by the first step
+    ca_lib_intent_t *intents; // 'ca_lib_simulate_intents': every cell's intent - allocated by the first step
+    size_t *winners; // 'ca_lib_simulate_intents': the index of the cell every cell was picked by, or 'CA_LIB_NO_WINNER'
+    struct intent_band *intent_bands; // 'ca_lib_simulate_intents': its jobs, planned by the first step and whenever the thread count changes
+    size_t intent_band_count;
+    struct block_band *block_bands; // 'ca_lib_simulate_margolus': its jobs, planned by the first step and whenever the thread count changes
+    size_t block_band_count;
+    unsigned char *block_saved; // 'ca_lib_simulate_margolus': four payloads per worker thread
+    unsigned int step; // Current step of 'ca_lib_simulate', compared against the cells' 'stamp'
+    uint64_t generation; // Number of steps taken by any engine - part of the key of 'ca_lib_random'
+    uint64_t seed; // Set by 'ca_lib_set_seed'
+    uint64_t *cell_hashes; // Every cell's contribution to 'state_hash' - NULL unless enabled by 'ca_lib_enable_state_hash'
+    _Atomic uint64_t state_hash; // XOR of all 'cell_hashes'
+    size_t hash_window; // Number of past states kept
+    uint64_t *window_hashes; // Ring buffer of the states the last 'hash_window' generations started from
+    uint64_t *window_generations; // The generation each of them was recorded at
+    size_t window_count; // Number of states recorded, at most 'hash_window'
+    size_t window_next; // Where the next state is recorded
+    ca_lib_classify_data_t classify_func; // Set by 'ca_lib_set_classifier' - NULL unless populations are counted
+    size_t class_count; // Number of classes 'classify_func' sorts the payloads into
+    uint32_t *cell_classes; // The class every cell is counted in - 'CA_LIB_UNCOUNTED' if none
+    atomic_size_t *populations; // 'class_count' counters - several workers may change cells at once
+    size_t thread_count; // Number of worker threads the parallel engines may use
+    bool pin_threads; // Set by 'ca_lib_set_thread_affinity'
+    ca_lib_thread_pool_t *threads; // Started by the first parallel step, NULL until then
+    bool local_rule; // The user has declared that the rule only writes to the simulated cell itself
+    size_t tile_size; // Side of the square tiles used by 'ca_lib_simulate_phased'
+    size_t chunks_x; // Number of 'CA_LIB_CHUNK_SIZE' wide chunks per row
+    size_t chunks_y; // Number of chunk rows
+    atomic_bool *dirty_chunks; // Chunks that had a cell changed since the last 'ca_lib_simulate_active' step began
+    bool *active_chunks; // Chunks to be visited by the current 'ca_lib_simulate_active' step
+    size_t stride; // Cells per row of 'cells' - 'width' + 2 halo cells
+    ca_lib_boundary_t boundary; // What the halo around the grid holds
+    void *boundary_data; // 'CA_LIB_BOUNDARY_CONSTANT': the grid-owned payload every halo cell points to
+    size_t boundary_size; // Size of 'boundary_data' in bytes
+    cell_t cells[]; // Allocate for ('width' + 2) * ('height' + 2) cells - the grid surrounded by a one cell wide halo
+};
+
+/*----FUNCTIONS SHARED BETWEEN THE MODULES----*/
+
+// Every engine starts its step with this - refreshes the halo, records the state hash and advances the generation
+void ca_lib_begin_generation(ca_lib_grid_t *grid);
+
+// Brings the state hash and population counts up to date after the payload of the cell at (x,y) was changed in place
+// Free unless 'ca_lib_enable_state_hash' or 'ca_lib_set_classifier' is in use
+void ca_lib_track_cell_change(ca_lib_grid_t *grid, size_t x, size_t y);
@@ -1,7 +1,13 @@
+#define _GNU_SOURCE // sched_getaffinity
 #include <string.h>
 #include <stdbool.h>
+#include <sched.h>
 #include <CUnit/Basic.h>
 #include "ca_lib.h"
+#include "ca_lib_bit_grid.h"
+#include "ca_lib_rule.h"
+#include "ca_lib_hashlife.h"
+#include "ca_lib_elementary.h"
 
 int init_suite(void)
 {
@@ -67,9 +73,77 @@ void polarize(ca_lib_grid_t *grid, data_t *data)
   }
 }
 
+void increment_int(ca_lib_grid_t *grid, data_t *data)
+{
+  *(int *)data->ptr += 1;
+}
+
+void count_visit(ca_lib_grid_t *grid, data_t *data)
+{
+  *(size_t *)ca_lib_get_meta_data(grid) += 1;
+}
+
+// Store the number of non-empty cells in the neighbourhood in the cell itself
+void count_neighbours(ca_lib_grid_t *grid, data_t *data, const ca_lib_neighbourhood_t *neighbourhood)
+{
+  int count = 0;
+  for (int dy = -neighbourhood->radius; dy <= neighbourhood->radius; dy++)
+  {
+    for (int dx = -neighbourhood->radius; dx <= neighbourhood->radius; dx++)
+    {
+      count += (dx || dy) && ca_lib_neighbour(neighbourhood, dx, dy) != NULL;
+    }
+  }
+  *(int *)data->ptr = count;
+}
+
+// Game of life on a typed grid of one byte cells, one row at a time
+void life_row(ca_lib_grid_t *grid, size_t y, size_t width, const void *above, const void *row, const void *below, void *out)
+{
+  const unsigned char *rows[3] = {above, row, below};
+  for (size_t x = 0; x < width; x++)
+  {
+    int n = 0;
+    for (int r = 0; r < 3; r++)
+    {
+      if (!rows[r]) { continue; }
+      n += (x > 0 && rows[r][x - 1]) + (r != 1 && rows[r][x]) + (x + 1 < width && rows[r][x + 1]);
+    }
+    ((unsigned char *)out)[x] = n == 3 || (n == 2 && ((const unsigned char *)row)[x]);
+  }
+}
+
+// Give every cell a fresh allocation holding its own index, like sand_sim's 'generate_cell_value'
+void assign_index(ca_lib_grid_t *grid, data_t *data)
+{
+  free(data->ptr);
+  data->ptr = malloc(sizeof(size_t));
+  *(size_t *)data->ptr = data->x + data->y * ca_lib_get_grid_width(grid);
+  data->size = sizeof(size_t);
+}
+
+void assign_pooled(ca_lib_grid_t *grid, data_t *data)
+{
+  if (data->x != 7 || data->y != 7) { return; }
+  ca_lib_free_pooled_ptr(data->ptr);
+  data->ptr = ca_lib_alloc_pooled_ptr(&(int){77}, sizeof(int));
+  data->size = sizeof(int);
+}
+
+void add_to_int(void *data_ptr, size_t data_size, void *arg)
+{
+  *(int *)data_ptr += *(int *)arg;
+}
+
+// Accumulate the cell's random draws, so every generation's draw shows up in the result
+void draw_random(ca_lib_grid_t *grid, data_t *data)
+{
+  *(uint64_t *)data->ptr = *(uint64_t *)data->ptr * 31 + ca_lib_random(grid, data->x, data->y, 0);
+}
+
 ca_lib_grid_t *sample_grid()
 {
-  ca_lib_grid_t *grid = ca_lib_create_grid(5, 5, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 5, 5, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
   bool bl = true;
   ca_lib_insert_cell(grid, 0, 0, sizeof(bool), &bl);
   bl = false;
@@ -79,7 +153,7 @@ ca_lib_grid_t *sample_grid()
 
 ca_lib_grid_t *sample_grid_cross()
 {
-  ca_lib_grid_t *grid = ca_lib_create_grid(5, 5, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 5, 5, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
   bool bl = true;
   bool bl2 = false;
   ca_lib_insert_cell(grid, 0, 0, sizeof(bool), &bl);
@@ -97,7 +171,7 @@ ca_lib_grid_t *sample_grid_cross()
 // Create, then destroy grid. Check that pointer is correct.
 void test_create_destroy_grid()
 {
-  ca_lib_grid_t *grid = ca_lib_create_grid(10, 10, NULL, NULL);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 10, 10, NULL, NULL);
   CU_ASSERT_PTR_NOT_NULL(grid);
   grid = ca_lib_destroy_grid(grid);
   CU_ASSERT_PTR_NULL(grid);
@@ -105,13 +179,13 @@ void test_create_destroy_grid()
 
 void test_print_grid()
 {
-  ca_lib_grid_t *grid = ca_lib_create_grid(10, 10, NULL, NULL);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 10, 10, NULL, NULL);
   grid = ca_lib_destroy_grid(grid);
 }
 
 void test_insert_once()
 {
-  ca_lib_grid_t *grid = ca_lib_create_grid(3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
   bool bl = true;
   CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, (size_t)1, (size_t)1).ptr);
   ca_lib_insert_cell(grid, 1, 1, sizeof(bool), &bl);
@@ -122,7 +196,7 @@ void test_insert_once()
 
 void test_insert_first_n_last()
 {
-  ca_lib_grid_t *grid = ca_lib_create_grid(3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
   bool bl = true;
   CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, 0, 0).ptr);
   CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, 2, 2).ptr);
@@ -137,7 +211,7 @@ void test_insert_first_n_last()
 
 void test_insert_on_cell_twice()
 {
-  ca_lib_grid_t *grid = ca_lib_create_grid(3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
   bool bl = true;
   CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, 1, 1).ptr);
   ca_lib_insert_cell(grid, 1, 1, sizeof(bool), &bl);
@@ -205,6 +279,1152 @@ void test_simulate_abstract()
   grid = ca_lib_destroy_grid(grid);
 }
 
+void test_simulate_abstract_moves_once()
+{
+  ca_lib_grid_t *grid = sample_grid(); // 'true' at (0,0) moves right, 'false' at (4,4) moves left
+  ca_lib_simulate(grid, polarize);
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 1, 0));
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 3, 4));
+  ca_lib_simulate(grid, polarize);
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 2, 0));
+  CU_ASSERT_TRUE(ca_lib_cell_empty(grid, 3, 0));
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 2, 4));
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_typed_grid_insert_switch()
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 4, 3, sizeof(int));
+  int a = 7;
+  int b = -3;
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 3, 2));
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 3, 2).ptr, 0);
+  ca_lib_insert_cell(grid, 0, 0, sizeof(int), &a);
+  ca_lib_insert_cell(grid, 3, 2, sizeof(int), &b);
+  void *slot = ca_lib_get_cell_data(grid, 0, 0).ptr;
+  ca_lib_switch_cells(grid, 0, 0, 3, 2);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 0, 0).ptr, -3);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 3, 2).ptr, 7);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 0, 0).ptr, slot); // payloads stay in place
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_typed_grid_move_clear()
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 3, 3, sizeof(int));
+  int a = 42;
+  ca_lib_insert_cell(grid, 1, 1, sizeof(int), &a);
+  ca_lib_move_cell(grid, 1, 1, 2, 0);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, 0).ptr, 42);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 1, 1).ptr, 0);
+  ca_lib_clear_cell(grid, 2, 0);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, 0).ptr, 0);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_simulate_unabstract_parallel()
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 17, 13, sizeof(int));
+  ca_lib_set_thread_count(grid, 4);
+  ca_lib_set_local_rule(grid, true);
+  for (size_t i = 0; i < 3; i++)
+  {
+    if (i == 2) { ca_lib_set_thread_count(grid, 2); } // The bands kept with the grid are planned anew
+    ca_lib_simulate_unabstract_parallel(grid, increment_int);
+  }
+  bool all_three = true;
+  for (size_t y = 0; y < 13; y++)
+  {
+    for (size_t x = 0; x < 17; x++)
+    {
+      all_three = all_three && *(int *)ca_lib_get_cell_data(grid, x, y).ptr == 3;
+    }
+  }
+  CU_ASSERT_TRUE(all_three);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_simulate_phased()
+{
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 20, 6, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_set_thread_count(grid, 3);
+  ca_lib_set_tile_size(grid, 3);
+  bool bl = true;
+  for (size_t y = 0; y < 6; y++)
+  {
+    ca_lib_insert_cell(grid, 0, y, sizeof(bool), &bl); // A column of cells moving right, crossing tiles
+  }
+  for (size_t i = 0; i < 5; i++)
+  {
+    if (i == 3) { ca_lib_set_tile_size(grid, 4); } // The tiles kept with the grid are listed anew
+    ca_lib_simulate_phased(grid, polarize);
+  }
+  bool moved_five = true;
+  for (size_t y = 0; y < 6; y++)
+  {
+    moved_five = moved_five && !ca_lib_cell_empty(grid, 5, y) && ca_lib_cell_empty(grid, 4, y) && ca_lib_cell_empty(grid, 6, y);
+  }
+  CU_ASSERT_TRUE(moved_five);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_simulate_active_skips_settled_chunks()
+{
+  size_t visits = 0;
+  ca_lib_grid_t *grid = ca_lib_create_grid(&visits, 200, 70, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_simulate_active(grid, count_visit); // Everything starts out dirty
+  CU_ASSERT_EQUAL(visits, 200 * 70);
+  visits = 0;
+  ca_lib_simulate_active(grid, count_visit); // Nothing changed
+  CU_ASSERT_EQUAL(visits, 0);
+  bool bl = true;
+  ca_lib_insert_cell(grid, 150, 10, sizeof(bool), &bl); // Wakes chunk (2,0) and its neighbours
+  ca_lib_simulate_active(grid, count_visit);
+  CU_ASSERT_EQUAL(visits, (64 + 64 + 8) * 70);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_bit_grid_blinker()
+{
+  ca_lib_bit_grid_t *grid = ca_lib_create_bit_grid(5, 5);
+  ca_lib_bit_grid_set(grid, 1, 2, true);
+  ca_lib_bit_grid_set(grid, 2, 2, true);
+  ca_lib_bit_grid_set(grid, 3, 2, true);
+  ca_lib_bit_grid_step(grid, CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL);
+  ca_lib_print_bit_grid(grid);
+  CU_ASSERT_TRUE(ca_lib_bit_grid_get(grid, 2, 1));
+  CU_ASSERT_TRUE(ca_lib_bit_grid_get(grid, 2, 3));
+  CU_ASSERT_FALSE(ca_lib_bit_grid_get(grid, 1, 2));
+  CU_ASSERT_EQUAL(ca_lib_bit_grid_population(grid), 3);
+  ca_lib_bit_grid_step(grid, CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL);
+  CU_ASSERT_TRUE(ca_lib_bit_grid_get(grid, 1, 2));
+  CU_ASSERT_FALSE(ca_lib_bit_grid_get(grid, 2, 1));
+  grid = ca_lib_destroy_bit_grid(grid);
+}
+
+// Straightforward Life-like step on a bool array, cells outside of the array are dead
+static void reference_life_step(bool *cells, size_t width, size_t height, uint16_t birth, uint16_t survival)
+{
+  bool *next = calloc(width * height, sizeof(bool));
+  for (size_t y = 0; y < height; y++)
+  {
+    for (size_t x = 0; x < width; x++)
+    {
+      int n = 0;
+      for (int dy = -1; dy <= 1; dy++)
+      {
+        for (int dx = -1; dx <= 1; dx++)
+        {
+          size_t nx = x + dx;
+          size_t ny = y + dy;
+          if ((dx || dy) && nx < width && ny < height && cells[nx + ny * width]) { n++; }
+        }
+      }
+      next[x + y * width] = cells[x + y * width] ? survival >> n & 1 : birth >> n & 1;
+    }
+  }
+  memcpy(cells, next, width * height * sizeof(bool));
+  free(next);
+}
+
+void test_bit_grid_matches_reference()
+{
+  const size_t width = 150;
+  const size_t height = 40;
+  const uint16_t rules[3][2] = {{CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL},
+                                {CA_LIB_NEIGHBOURS(3) | CA_LIB_NEIGHBOURS(6), CA_LIB_LIFE_SURVIVAL}, // HighLife
+                                {CA_LIB_NEIGHBOURS(0) | CA_LIB_NEIGHBOURS(8), CA_LIB_NEIGHBOURS(4) | CA_LIB_NEIGHBOURS(8)}};
+  bool *reference = calloc(width * height, sizeof(bool));
+  for (size_t r = 0; r < 3; r++)
+  {
+    ca_lib_bit_grid_t *grid = ca_lib_create_bit_grid(width, height);
+    srand(r + 1);
+    for (size_t i = 0; i < width * height; i++)
+    {
+      reference[i] = rand() % 3 == 0;
+      ca_lib_bit_grid_set(grid, i % width, i / width, reference[i]);
+    }
+    bool equal = true;
+    for (size_t step = 0; step < 20; step++)
+    {
+      ca_lib_bit_grid_step(grid, rules[r][0], rules[r][1]);
+      reference_life_step(reference, width, height, rules[r][0], rules[r][1]);
+      for (size_t i = 0; i < width * height; i++)
+      {
+        equal = equal && ca_lib_bit_grid_get(grid, i % width, i / width) == reference[i];
+      }
+    }
+    CU_ASSERT_TRUE(equal);
+    grid = ca_lib_destroy_bit_grid(grid);
+  }
+  free(reference);
+}
+
+void test_compile_rule()
+{
+  ca_lib_rule_t *life = ca_lib_compile_rule("B3/S23");
+  CU_ASSERT_PTR_NOT_NULL(life);
+  CU_ASSERT_EQUAL(ca_lib_rule_birth_mask(life), CA_LIB_LIFE_BIRTH);
+  CU_ASSERT_EQUAL(ca_lib_rule_survival_mask(life), CA_LIB_LIFE_SURVIVAL);
+  CU_ASSERT_EQUAL(ca_lib_rule_state_count(life), 2);
+  life = ca_lib_destroy_rule(life);
+
+  ca_lib_rule_t *highlife = ca_lib_compile_rule("23/36"); // S/B notation
+  CU_ASSERT_EQUAL(ca_lib_rule_birth_mask(highlife), CA_LIB_NEIGHBOURS(3) | CA_LIB_NEIGHBOURS(6));
+  highlife = ca_lib_destroy_rule(highlife);
+
+  ca_lib_rule_t *brain = ca_lib_compile_rule("B2/S/C3"); // Brian's Brain
+  CU_ASSERT_EQUAL(ca_lib_rule_state_count(brain), 3);
+  CU_ASSERT_EQUAL(ca_lib_rule_next_state(brain, 0, 2), 1);
+  CU_ASSERT_EQUAL(ca_lib_rule_next_state(brain, 1, 2), 2);
+  CU_ASSERT_EQUAL(ca_lib_rule_next_state(brain, 2, 5), 0);
+  brain = ca_lib_destroy_rule(brain);
+
+  CU_ASSERT_PTR_NULL(ca_lib_compile_rule("B9/S23"));
+  CU_ASSERT_PTR_NULL(ca_lib_compile_rule("B3/S23/C1"));
+  CU_ASSERT_PTR_NULL(ca_lib_compile_rule(""));
+  CU_ASSERT_PTR_NULL(ca_lib_compile_rule("B3/B4/S23")); // Sections given twice
+  CU_ASSERT_PTR_NULL(ca_lib_compile_rule("B3/S23/S1"));
+  CU_ASSERT_PTR_NULL(ca_lib_compile_rule("B2/S/C3/G4"));
+  CU_ASSERT_PTR_NULL(ca_lib_compile_rule("23/S3")); // Survival given by position, then by label
+}
+
+void test_simulate_rule_honours_boundary()
+{
+  // A blinker across the top and bottom edges only blinks if they meet
+  ca_lib_rule_t *life = ca_lib_compile_rule("B3/S23");
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 5, 5, sizeof(uint8_t));
+  ca_lib_set_boundary(grid, CA_LIB_BOUNDARY_PERIODIC, 0, NULL);
+  uint8_t alive = 1;
+  ca_lib_insert_cell(grid, 2, 4, sizeof(uint8_t), &alive);
+  ca_lib_insert_cell(grid, 2, 0, sizeof(uint8_t), &alive);
+  ca_lib_insert_cell(grid, 2, 1, sizeof(uint8_t), &alive);
+  ca_lib_simulate_rule(grid, life);
+  size_t count = 0;
+  for (size_t i = 0; i < 25; i++) { count += *(uint8_t *)ca_lib_get_cell_data(grid, i % 5, i / 5).ptr; }
+  CU_ASSERT_EQUAL(count, 3);
+  CU_ASSERT_EQUAL(*(uint8_t *)ca_lib_get_cell_data(grid, 1, 0).ptr, 1);
+  CU_ASSERT_EQUAL(*(uint8_t *)ca_lib_get_cell_data(grid, 3, 0).ptr, 1);
+  ca_lib_simulate_rule(grid, life);
+  CU_ASSERT_EQUAL(*(uint8_t *)ca_lib_get_cell_data(grid, 2, 4).ptr, 1);
+  CU_ASSERT_EQUAL(*(uint8_t *)ca_lib_get_cell_data(grid, 1, 0).ptr, 0);
+  grid = ca_lib_destroy_grid(grid);
+
+  // A live constant boundary gives every edge cell live neighbours
+  grid = ca_lib_create_typed_grid(NULL, 3, 3, sizeof(uint8_t));
+  ca_lib_set_boundary(grid, CA_LIB_BOUNDARY_CONSTANT, sizeof(uint8_t), &alive);
+  ca_lib_simulate_rule(grid, life);
+  CU_ASSERT_EQUAL(*(uint8_t *)ca_lib_get_cell_data(grid, 1, 0).ptr, 1); // 3 neighbours outside
+  CU_ASSERT_EQUAL(*(uint8_t *)ca_lib_get_cell_data(grid, 0, 0).ptr, 0); // 5 neighbours outside
+  CU_ASSERT_EQUAL(*(uint8_t *)ca_lib_get_cell_data(grid, 1, 1).ptr, 0);
+  grid = ca_lib_destroy_grid(grid);
+  life = ca_lib_destroy_rule(life);
+}
+
+void test_simulate_rule_matches_bit_grid()
+{
+  const size_t width = 70;
+  const size_t height = 30;
+  ca_lib_rule_t *rule = ca_lib_compile_rule("B36/S23");
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, width, height, sizeof(uint8_t));
+  ca_lib_bit_grid_t *bits = ca_lib_create_bit_grid(width, height);
+  srand(7);
+  for (size_t i = 0; i < width * height; i++)
+  {
+    uint8_t state = rand() % 2;
+    ca_lib_insert_cell(grid, i % width, i / width, sizeof(uint8_t), &state);
+    ca_lib_bit_grid_set(bits, i % width, i / width, state);
+  }
+  bool equal = true;
+  for (size_t step = 0; step < 15; step++)
+  {
+    ca_lib_simulate_rule(grid, rule);
+    ca_lib_bit_grid_step(bits, ca_lib_rule_birth_mask(rule), ca_lib_rule_survival_mask(rule));
+    for (size_t i = 0; i < width * height; i++)
+    {
+      equal = equal && *(uint8_t *)ca_lib_get_cell_data(grid, i % width, i / width).ptr == ca_lib_bit_grid_get(bits, i % width, i / width);
+    }
+  }
+  CU_ASSERT_TRUE(equal);
+  bits = ca_lib_destroy_bit_grid(bits);
+  grid = ca_lib_destroy_grid(grid);
+  rule = ca_lib_destroy_rule(rule);
+}
+
+bool bool_is_true(void *data_ptr)
+{
+  return data_ptr && *(bool *)data_ptr;
+}
+
+void test_hashlife_glider()
+{
+  ca_lib_hashlife_t *hl = ca_lib_create_hashlife(CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL);
+  // Glider heading towards +x, +y
+  ca_lib_hashlife_set_cell(hl, 1, 0, true);
+  ca_lib_hashlife_set_cell(hl, 2, 1, true);
+  ca_lib_hashlife_set_cell(hl, 0, 2, true);
+  ca_lib_hashlife_set_cell(hl, 1, 2, true);
+  ca_lib_hashlife_set_cell(hl, 2, 2, true);
+  ca_lib_hashlife_step(hl, 2); // 4 generations moves it one cell diagonally
+  CU_ASSERT_EQUAL(ca_lib_hashlife_generation(hl), 4);
+  CU_ASSERT_EQUAL(ca_lib_hashlife_population(hl), 5);
+  CU_ASSERT_TRUE(ca_lib_hashlife_get_cell(hl, 2, 1));
+  CU_ASSERT_TRUE(ca_lib_hashlife_get_cell(hl, 3, 3));
+  CU_ASSERT_FALSE(ca_lib_hashlife_get_cell(hl, 1, 0));
+  ca_lib_hashlife_step(hl, 10); // 1024 more generations - 256 cells further
+  CU_ASSERT_EQUAL(ca_lib_hashlife_population(hl), 5);
+  CU_ASSERT_TRUE(ca_lib_hashlife_get_cell(hl, 258, 257));
+  CU_ASSERT_TRUE(ca_lib_hashlife_get_cell(hl, 259, 259));
+  hl = ca_lib_destroy_hashlife(hl);
+}
+
+void test_hashlife_matches_bit_grid()
+{
+  const size_t side = 160;
+  const size_t soup = 24;
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, side, side, sizeof(bool));
+  ca_lib_bit_grid_t *bits = ca_lib_create_bit_grid(side, side);
+  srand(11);
+  for (size_t y = (side - soup) / 2; y < (side + soup) / 2; y++)
+  {
+    for (size_t x = (side - soup) / 2; x < (side + soup) / 2; x++)
+    {
+      bool alive = rand() % 2;
+      ca_lib_insert_cell(grid, x, y, sizeof(bool), &alive);
+      ca_lib_bit_grid_set(bits, x, y, alive);
+    }
+  }
+  ca_lib_hashlife_t *hl = ca_lib_create_hashlife(CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL);
+  ca_lib_hashlife_import(hl, grid, 0, 0, side, side, bool_is_true);
+  ca_lib_hashlife_step(hl, 3);
+  ca_lib_hashlife_step(hl, 5); // Soup can't reach the edges of the bit grid in 40 generations
+  for (size_t i = 0; i < 40; i++)
+  {
+    ca_lib_bit_grid_step(bits, CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL);
+  }
+  bool alive = true;
+  ca_lib_hashlife_export(hl, grid, 0, 0, side, side, sizeof(bool), &alive);
+  CU_ASSERT_EQUAL(ca_lib_hashlife_population(hl), ca_lib_bit_grid_population(bits));
+  bool equal = true;
+  for (size_t i = 0; i < side * side; i++)
+  {
+    equal = equal && *(bool *)ca_lib_get_cell_data(grid, i % side, i / side).ptr == ca_lib_bit_grid_get(bits, i % side, i / side);
+  }
+  CU_ASSERT_TRUE(equal);
+  hl = ca_lib_destroy_hashlife(hl);
+  bits = ca_lib_destroy_bit_grid(bits);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_elementary_matches_reference()
+{
+  const size_t width = 150;
+  bool reference[150];
+  bool next[150];
+  for (int wrap = 0; wrap < 2; wrap++)
+  {
+    ca_lib_elementary_t *ca = ca_lib_create_elementary(width, 30, wrap);
+    srand(3);
+    for (size_t x = 0; x < width; x++)
+    {
+      reference[x] = rand() % 2;
+      ca_lib_elementary_set(ca, x, reference[x]);
+    }
+    bool equal = true;
+    for (size_t step = 0; step < 40; step++)
+    {
+      ca_lib_elementary_step(ca);
+      for (size_t x = 0; x < width; x++)
+      {
+        bool l = x > 0 ? reference[x - 1] : (wrap && reference[width - 1]);
+        bool r = x + 1 < width ? reference[x + 1] : (wrap && reference[0]);
+        next[x] = 30 >> (4 * l + 2 * reference[x] + r) & 1;
+      }
+      memcpy(reference, next, sizeof(reference));
+      for (size_t x = 0; x < width; x++)
+      {
+        equal = equal && ca_lib_elementary_get(ca, x) == reference[x];
+      }
+    }
+    CU_ASSERT_TRUE(equal);
+    ca = ca_lib_destroy_elementary(ca);
+  }
+}
+
+void test_totalistic_matches_reference()
+{
+  const size_t width = 130;
+  const int radius = 3;
+  const uint64_t code = 0x5A; // Live with 1, 3, 4 or 6 live cells in the neighbourhood
+  bool reference[130];
+  bool next[130];
+  ca_lib_elementary_t *ca = ca_lib_create_totalistic(width, radius, code, true);
+  srand(5);
+  for (size_t x = 0; x < width; x++)
+  {
+    reference[x] = rand() % 2;
+    ca_lib_elementary_set(ca, x, reference[x]);
+  }
+  bool equal = true;
+  for (size_t step = 0; step < 30; step++)
+  {
+    ca_lib_elementary_step(ca);
+    for (size_t x = 0; x < width; x++)
+    {
+      int sum = 0;
+      for (int d = -radius; d <= radius; d++)
+      {
+        sum += reference[(x + width + d) % width];
+      }
+      next[x] = code >> sum & 1;
+    }
+    memcpy(reference, next, sizeof(reference));
+    for (size_t x = 0; x < width; x++)
+    {
+      equal = equal && ca_lib_elementary_get(ca, x) == reference[x];
+    }
+  }
+  CU_ASSERT_TRUE(equal);
+  ca = ca_lib_destroy_elementary(ca);
+  CU_ASSERT_PTR_NULL(ca_lib_create_totalistic(width, 0, code, true));
+
+  // A neighbourhood wider than the wrapping row reaches some cells more than once
+  const size_t narrow = 5;
+  const int wide_radius = 7;
+  const uint64_t wide_code = 0x2AAAAAAAAAAAull; // Live with an odd count
+  ca = ca_lib_create_totalistic(narrow, wide_radius, wide_code, true);
+  srand(9);
+  for (size_t x = 0; x < narrow; x++)
+  {
+    reference[x] = rand() % 2;
+    ca_lib_elementary_set(ca, x, reference[x]);
+  }
+  for (size_t step = 0; step < 10; step++)
+  {
+    ca_lib_elementary_step(ca);
+    for (size_t x = 0; x < narrow; x++)
+    {
+      int sum = 0;
+      for (int d = -wide_radius; d <= wide_radius; d++)
+      {
+        sum += reference[(x + 2 * narrow + d) % narrow];
+      }
+      next[x] = wide_code >> sum & 1;
+    }
+    memcpy(reference, next, narrow * sizeof(bool));
+    for (size_t x = 0; x < narrow; x++)
+    {
+      equal = equal && ca_lib_elementary_get(ca, x) == reference[x];
+    }
+  }
+  CU_ASSERT_TRUE(equal);
+  ca = ca_lib_destroy_elementary(ca);
+}
+
+void test_elementary_write_history()
+{
+  ca_lib_elementary_t *ca = ca_lib_create_elementary(9, 90, false);
+  ca_lib_elementary_set(ca, 4, true);
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 9, 4, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  bool alive = true;
+  ca_lib_elementary_write_history(ca, grid, sizeof(bool), &alive);
+  ca_lib_print_grid(grid, empty_vs_full);
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 4, 3)); // Generation 0 on top
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 3, 2));
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 5, 2));
+  CU_ASSERT_TRUE(ca_lib_cell_empty(grid, 4, 2));
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 1, 0));
+  CU_ASSERT_FALSE(ca_lib_cell_empty(grid, 7, 0));
+  CU_ASSERT_TRUE(ca_lib_cell_empty(grid, 4, 0));
+  grid = ca_lib_destroy_grid(grid);
+  ca = ca_lib_destroy_elementary(ca);
+}
+
+void test_simulate_neighbourhood()
+{
+  // Every cell of a typed grid is non-empty, so the counts only depend on the edges and the shape
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 6, 5, sizeof(int));
+  ca_lib_simulate_neighbourhood(grid, CA_LIB_MOORE, 1, count_neighbours);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 0, 0).ptr, 3);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 3, 0).ptr, 5);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, 2).ptr, 8);
+  ca_lib_simulate_neighbourhood(grid, CA_LIB_VON_NEUMANN, 1, count_neighbours);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 0, 0).ptr, 2);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, 2).ptr, 4);
+  ca_lib_simulate_neighbourhood(grid, CA_LIB_MOORE, 2, count_neighbours);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, 2).ptr, 24);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 5, 4).ptr, 8);
+  ca_lib_simulate_neighbourhood(grid, CA_LIB_VON_NEUMANN, 2, count_neighbours);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, 2).ptr, 12);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_simulate_rows()
+{
+  // Compare against the byte-per-cell reference - with several bands, so the band edges are exercised
+  size_t w = 37, h = 29;
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, w, h, 1);
+  ca_lib_set_thread_count(grid, 3);
+  bool *expected = calloc(w * h, sizeof(bool));
+  unsigned char one = 1;
+  srand(11);
+  for (size_t i = 0; i < w * h; i++)
+  {
+    expected[i] = rand() % 3 == 0;
+    if (expected[i]) { ca_lib_insert_cell(grid, i % w, i / w, 1, &one); }
+  }
+  bool equal = true;
+  for (int step = 0; step < 20; step++)
+  {
+    if (step == 10) { ca_lib_set_thread_count(grid, 5); } // The bands kept with the grid are planned anew
+    ca_lib_simulate_rows(grid, life_row);
+    reference_life_step(expected, w, h, CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL);
+    for (size_t i = 0; i < w * h; i++)
+    {
+      equal &= *(unsigned char *)ca_lib_get_cell_data(grid, i % w, i / w).ptr == expected[i];
+    }
+  }
+  CU_ASSERT(equal);
+  free(expected);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_boundary()
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 4, 3, sizeof(int));
+  for (int i = 0; i < 12; i++)
+  {
+    ca_lib_insert_cell(grid, i % 4, i / 4, sizeof(int), &i);
+  }
+  CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, -1, 0).ptr);
+
+  ca_lib_set_boundary(grid, CA_LIB_BOUNDARY_PERIODIC, 0, NULL);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, -1, 0).ptr, 3);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 4, 2).ptr, 8);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, -1, -1).ptr, 11);
+  ca_lib_simulate_neighbourhood(grid, CA_LIB_MOORE, 2, count_neighbours); // Every cell of a torus has a full neighbourhood
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 0, 0).ptr, 24);
+
+  ca_lib_set_boundary(grid, CA_LIB_BOUNDARY_REFLECTIVE, 0, NULL);
+  ca_lib_insert_cell(grid, 0, 1, sizeof(int), &(int){7});
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, -1, 1).ptr, 7);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 4, 3).ptr, *(int *)ca_lib_get_cell_data(grid, 3, 2).ptr);
+
+  int wall = 42;
+  ca_lib_set_boundary(grid, CA_LIB_BOUNDARY_CONSTANT, sizeof(int), &wall);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, -1).ptr, 42);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 4, 3).ptr, 42);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_boundary_follows_pointer_cells()
+{
+  // The halo of a pointer grid aliases the edge cells, so it must follow them as they are replaced
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_set_boundary(grid, CA_LIB_BOUNDARY_PERIODIC, 0, NULL);
+  bool t = true;
+  ca_lib_insert_cell(grid, 2, 2, sizeof(bool), &t);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, -1, -1).ptr, ca_lib_get_cell_data(grid, 2, 2).ptr);
+  ca_lib_move_cell(grid, 2, 2, 0, 2);
+  CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, -1, -1).ptr);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 3, 2).ptr, ca_lib_get_cell_data(grid, 0, 2).ptr);
+  ca_lib_switch_cells(grid, 0, 2, 1, 1);
+  CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, 3, -1).ptr);
+  ca_lib_insert_cell(grid, 2, 1, sizeof(bool), &t);
+  ca_lib_clear_cell(grid, -1, 1); // The halo aliases (2,1) - ignored rather than freed twice
+  CU_ASSERT_PTR_NOT_NULL(ca_lib_get_cell_data(grid, 2, 1).ptr);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, -1, 1).ptr, ca_lib_get_cell_data(grid, 2, 1).ptr);
+  ca_lib_clear_cell(grid, 1, 1);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_rule_assigned_data_is_kept()
+{
+  // Cells store no coordinates, so the data_t handed to the rule is rebuilt from the position and written back
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 5, 4, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_simulate_unabstract(grid, assign_index);
+  bool all = true;
+  for (size_t i = 0; i < 20; i++)
+  {
+    data_t data = ca_lib_get_cell_data(grid, i % 5, i / 5);
+    all &= data.x == i % 5 && data.y == i / 5 && data.size == sizeof(size_t) && *(size_t *)data.ptr == i;
+  }
+  CU_ASSERT(all);
+  ca_lib_switch_cells(grid, 0, 0, 4, 3);
+  data_t data = ca_lib_get_cell_data(grid, 4, 3);
+  CU_ASSERT(data.x == 4 && data.y == 3 && *(size_t *)data.ptr == 0);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_pooled_allocator()
+{
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 8, 8, ca_lib_alloc_pooled_ptr, ca_lib_free_pooled_ptr);
+  int value = 5;
+  ca_lib_insert_cell(grid, 1, 1, sizeof(int), &value);
+  void *first = ca_lib_get_cell_data(grid, 1, 1).ptr;
+  CU_ASSERT_EQUAL(*(int *)first, 5);
+  ca_lib_clear_cell(grid, 1, 1);
+  ca_lib_insert_cell(grid, 2, 2, sizeof(int), &value);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 2, 2).ptr, first); // The freed payload is reused straight away
+
+  // Payloads too large for a size class get a slab of their own
+  char *large = calloc(100000, 1);
+  large[99999] = 'x';
+  ca_lib_insert_cell(grid, 3, 3, 100000, large);
+  CU_ASSERT_EQUAL(((char *)ca_lib_get_cell_data(grid, 3, 3).ptr)[99999], 'x');
+  ca_lib_clear_cell(grid, 3, 3);
+
+  // Owned payloads must come from a pool - anything else is refused, its owner never read through
+  ca_lib_insert_owned_cell(grid, 3, 3, 100000, large);
+  CU_ASSERT(ca_lib_cell_empty(grid, 3, 3));
+  free(large);
+  void *pooled = ca_lib_alloc_pooled_ptr(&value, sizeof(int));
+  ca_lib_insert_owned_cell(grid, 4, 4, sizeof(int), pooled);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 4, 4).ptr, pooled);
+
+  // Rules allocate from the shared pool, whose payloads destroy frees one by one before releasing the grid's own pool
+  ca_lib_simulate_unabstract(grid, assign_pooled);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 7, 7).ptr, 77);
+  ca_lib_insert_cell(grid, 0, 0, sizeof(int), &value);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+// Turns the cell at (3,0) into a 2 the way a rule does it, through the allocator pair
+static void assign_interned_two(ca_lib_grid_t *grid, data_t *data)
+{
+  if (data->x != 3 || data->y != 0) { return; }
+  int two = 2;
+  ca_lib_free_interned_ptr(data->ptr);
+  data->ptr = ca_lib_alloc_interned_ptr(&two, sizeof(int));
+}
+
+void test_interned_cells()
+{
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 4, 4, ca_lib_alloc_interned_ptr, ca_lib_free_interned_ptr);
+  int a = 1, b = 2;
+  for (size_t i = 0; i < 16; i++)
+  {
+    ca_lib_insert_cell(grid, i % 4, i / 4, sizeof(int), i % 2 ? &a : &b);
+  }
+  // Equal payloads are one allocation
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 1, 0).ptr, ca_lib_get_cell_data(grid, 3, 3).ptr);
+  CU_ASSERT(ca_lib_get_cell_data(grid, 0, 0).ptr != ca_lib_get_cell_data(grid, 1, 0).ptr);
+
+  // Copy on write leaves the other cells alone, and lands on the payload that already holds the new value
+  int one = 1;
+  ca_lib_modify_cell(grid, 0, 0, add_to_int, &one);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 0, 0).ptr, 3);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 2, 0).ptr, 2);
+  int minus_two = -2;
+  ca_lib_modify_cell(grid, 0, 0, add_to_int, &minus_two);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 0, 0).ptr, ca_lib_get_cell_data(grid, 1, 0).ptr);
+
+  ca_lib_move_cell(grid, 1, 0, 2, 0);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 2, 0).ptr, ca_lib_get_cell_data(grid, 0, 0).ptr);
+  CU_ASSERT_PTR_NULL(ca_lib_get_cell_data(grid, 1, 0).ptr);
+
+  // Only interned payloads can be handed over - a foreign one would be released through a header it doesn't have
+  int *foreign = malloc(sizeof(int));
+  ca_lib_insert_owned_cell(grid, 1, 0, sizeof(int), foreign);
+  CU_ASSERT(ca_lib_cell_empty(grid, 1, 0));
+  free(foreign);
+  ca_lib_insert_owned_cell(grid, 1, 0, sizeof(int), ca_lib_alloc_interned_ptr(&a, sizeof(int)));
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 1, 0).ptr, 1);
+
+  // A payload assigned by a rule is the same pointer as an equal inserted one
+  ca_lib_simulate(grid, assign_interned_two);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 3, 0).ptr, ca_lib_get_cell_data(grid, 0, 1).ptr);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_arena_reset()
+{
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 50, 50, ca_lib_alloc_arena_ptr, ca_lib_free_arena_ptr);
+  int value = 9;
+  ca_lib_insert_cell(grid, 0, 0, sizeof(int), &value);
+  void *first = ca_lib_get_cell_data(grid, 0, 0).ptr;
+  for (int run = 0; run < 3; run++)
+  {
+    for (size_t i = 0; i < 2500; i++)
+    {
+      ca_lib_insert_cell(grid, i % 50, i / 50, sizeof(int), &value); // Overwrites keep using up the arena until the reset
+    }
+    CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 49, 49).ptr, 9);
+    ca_lib_reset_grid(grid);
+    CU_ASSERT(ca_lib_cell_empty(grid, 49, 49));
+  }
+  ca_lib_insert_cell(grid, 3, 3, sizeof(int), &value);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 3, 3).ptr, first); // The arena starts over from its first region
+  grid = ca_lib_destroy_grid(grid);
+
+  // Typed grids are zeroed, pointer grids emptied
+  grid = ca_lib_create_typed_grid(NULL, 3, 3, sizeof(int));
+  ca_lib_insert_cell(grid, 1, 1, sizeof(int), &value);
+  ca_lib_reset_grid(grid);
+  CU_ASSERT_EQUAL(*(int *)ca_lib_get_cell_data(grid, 1, 1).ptr, 0);
+  grid = ca_lib_destroy_grid(grid);
+  grid = ca_lib_create_grid(NULL, 3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_insert_cell(grid, 1, 1, sizeof(int), &value);
+  ca_lib_reset_grid(grid);
+  CU_ASSERT(ca_lib_cell_empty(grid, 1, 1));
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_ownership_transfer()
+{
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 3, 3, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  int *owned = malloc(sizeof(int));
+  *owned = 4;
+  ca_lib_insert_owned_cell(grid, 0, 0, sizeof(int), owned);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 0, 0).ptr, owned);
+
+  // Moving hands the same pointer over, and moving a cell onto itself keeps it
+  ca_lib_insert_cell(grid, 2, 2, sizeof(int), &(int){1});
+  ca_lib_move_cell(grid, 0, 0, 2, 2);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 2, 2).ptr, owned);
+  CU_ASSERT(ca_lib_cell_empty(grid, 0, 0));
+  ca_lib_move_cell(grid, 2, 2, 2, 2);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 2, 2).ptr, owned);
+
+  data_t taken = ca_lib_take_cell(grid, 2, 2);
+  CU_ASSERT_PTR_EQUAL(taken.ptr, owned);
+  CU_ASSERT_EQUAL(taken.size, sizeof(int));
+  CU_ASSERT(ca_lib_cell_empty(grid, 2, 2));
+  grid = ca_lib_destroy_grid(grid);
+  CU_ASSERT_EQUAL(*owned, 4); // Still alive after the grid is gone
+  free(owned);
+}
+
+// Run 'draw_random' a few generations on a new grid
+static ca_lib_grid_t *random_grid(uint64_t seed, size_t thread_count)
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 17, 13, sizeof(uint64_t));
+  ca_lib_set_seed(grid, seed);
+  ca_lib_set_thread_count(grid, thread_count);
+  ca_lib_set_local_rule(grid, true);
+  for (int step = 0; step < 3; step++)
+  {
+    ca_lib_simulate_unabstract_parallel(grid, draw_random);
+  }
+  return grid;
+}
+
+void test_random_is_reproducible()
+{
+  ca_lib_grid_t *single = random_grid(7, 1);
+  ca_lib_grid_t *parallel = random_grid(7, 4);
+  ca_lib_grid_t *other_seed = random_grid(8, 1);
+  CU_ASSERT_EQUAL(ca_lib_get_generation(single), 3);
+  bool same = true, differs = false, cells_differ = false;
+  for (size_t i = 0; i < 17 * 13; i++)
+  {
+    uint64_t value = *(uint64_t *)ca_lib_get_cell_data(single, i % 17, i / 17).ptr;
+    same &= value == *(uint64_t *)ca_lib_get_cell_data(parallel, i % 17, i / 17).ptr;
+    differs |= value != *(uint64_t *)ca_lib_get_cell_data(other_seed, i % 17, i / 17).ptr;
+    cells_differ |= value != *(uint64_t *)ca_lib_get_cell_data(single, 0, 0).ptr;
+  }
+  CU_ASSERT(same);
+  CU_ASSERT(differs);
+  CU_ASSERT(cells_differ);
+  CU_ASSERT(ca_lib_random(single, 1, 2, 0) == ca_lib_random(single, 1, 2, 0));
+  CU_ASSERT(ca_lib_random(single, 1, 2, 0) != ca_lib_random(single, 1, 2, 1));
+  single = ca_lib_destroy_grid(single);
+  parallel = ca_lib_destroy_grid(parallel);
+  other_seed = ca_lib_destroy_grid(other_seed);
+}
+
+static void clear_data(ca_lib_grid_t *grid, data_t *data)
+{
+  ca_lib_clear_cell(grid, data->x, data->y);
+}
+
+static void clear_all_step(ca_lib_grid_t *grid)
+{
+  ca_lib_simulate_unabstract(grid, clear_data);
+}
+
+static void life_rows_step(ca_lib_grid_t *grid)
+{
+  ca_lib_simulate_rows(grid, life_row);
+}
+
+void test_state_hash_finds_cycles()
+{
+  unsigned char one = 1;
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 8, 8, 1);
+  ca_lib_enable_state_hash(grid, 4);
+  uint64_t empty = ca_lib_get_state_hash(grid);
+  for (size_t x = 2; x < 5; x++) { ca_lib_insert_cell(grid, x, 3, 1, &one); } // Blinker
+  CU_ASSERT(ca_lib_get_state_hash(grid) != empty);
+  CU_ASSERT_EQUAL(ca_lib_get_cycle_period(grid), 0);
+
+  ca_lib_rule_t *life = ca_lib_compile_rule("B3/S23");
+  ca_lib_simulate_rule(grid, life);
+  CU_ASSERT_EQUAL(ca_lib_get_cycle_period(grid), 0);
+  ca_lib_simulate_rule(grid, life);
+  CU_ASSERT_EQUAL(ca_lib_get_cycle_period(grid), 2);
+  life = ca_lib_destroy_rule(life);
+
+  // A still life after the reset - the row engine must see it too
+  ca_lib_reset_grid(grid);
+  CU_ASSERT_EQUAL(ca_lib_get_state_hash(grid), empty);
+  for (size_t i = 0; i < 4; i++) { ca_lib_insert_cell(grid, 4 + i % 2, 4 + i / 2, 1, &one); } // Block
+  CU_ASSERT_EQUAL(ca_lib_run_until_stable(grid, life_rows_step, 100), 1);
+  CU_ASSERT_EQUAL(ca_lib_get_cycle_period(grid), 1);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_run_until_stable_stops_early()
+{
+  // A lone cell dies in one step, so the second step repeats the empty grid
+  int value = 1;
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 6, 6, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_enable_state_hash(grid, 8);
+  ca_lib_insert_cell(grid, 1, 1, sizeof(int), &value);
+  ca_lib_set_local_rule(grid, true);
+  CU_ASSERT_EQUAL(ca_lib_run_until_stable(grid, clear_all_step, 1000), 2);
+  CU_ASSERT_EQUAL(ca_lib_get_generation(grid), 2);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+static size_t byte_class(void *data_ptr, size_t data_size)
+{
+  return *(unsigned char *)data_ptr;
+}
+
+static size_t int_class(void *data_ptr, size_t data_size)
+{
+  return *(int *)data_ptr;
+}
+
+void test_population_counts()
+{
+  int values[] = {0, 1, 1, 2, 7}; // 7 is outside of the classes
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 5, 5, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_insert_cell(grid, 0, 0, sizeof(int), &values[0]);
+  ca_lib_set_classifier(grid, 3, int_class);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 0), 1); // Counted from what was already there
+  for (size_t i = 1; i < 5; i++) { ca_lib_insert_cell(grid, i, 1, sizeof(int), &values[i]); }
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 1), 2);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 2), 1);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 7), 0);
+
+  ca_lib_insert_cell(grid, 1, 1, sizeof(int), &values[3]); // 1 -> 2
+  ca_lib_move_cell(grid, 2, 1, 3, 3);
+  ca_lib_switch_cells(grid, 0, 0, 4, 4);
+  ca_lib_clear_cell(grid, 3, 1);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 0), 1);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 1), 1);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 2), 1);
+
+  ca_lib_reset_grid(grid);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 1), 0);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_population_follows_engines()
+{
+  unsigned char one = 1;
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 8, 8, 1);
+  ca_lib_set_classifier(grid, 2, byte_class);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 0), 64); // Typed cells are never empty
+  for (size_t x = 2; x < 5; x++) { ca_lib_insert_cell(grid, x, 3, 1, &one); } // Blinker
+  ca_lib_rule_t *life = ca_lib_compile_rule("B3/S23");
+  ca_lib_simulate_rule(grid, life);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 1), 3);
+  CU_ASSERT_EQUAL(*(unsigned char *)ca_lib_get_cell_data(grid, 3, 2).ptr, 1);
+  life = ca_lib_destroy_rule(life);
+  ca_lib_simulate_rows(grid, life_row);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 1), 3);
+  CU_ASSERT_EQUAL(ca_lib_get_population(grid, 0), 61);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_simulate_rows_blocked()
+{
+  // Against the plain row engine - small tiles and several threads, so the margins overlap other tiles and the grid's edges
+  size_t w = 37, h = 29;
+  ca_lib_grid_t *plain = ca_lib_create_typed_grid(NULL, w, h, 1);
+  ca_lib_grid_t *blocked = ca_lib_create_typed_grid(NULL, w, h, 1);
+  ca_lib_set_tile_size(blocked, 8);
+  ca_lib_set_thread_count(blocked, 3);
+  unsigned char one = 1;
+  srand(5);
+  for (size_t i = 0; i < w * h; i++)
+  {
+    if (rand() % 3 == 0)
+    {
+      ca_lib_insert_cell(plain, i % w, i / w, 1, &one);
+      ca_lib_insert_cell(blocked, i % w, i / w, 1, &one);
+    }
+  }
+  bool equal = true;
+  for (int round = 0; round < 4; round++)
+  {
+    for (int step = 0; step < 5; step++) { ca_lib_simulate_rows(plain, life_row); }
+    ca_lib_simulate_rows_blocked(blocked, life_row, 5);
+    for (size_t i = 0; i < w * h; i++)
+    {
+      equal &= *(unsigned char *)ca_lib_get_cell_data(plain, i % w, i / w).ptr == *(unsigned char *)ca_lib_get_cell_data(blocked, i % w, i / w).ptr;
+    }
+  }
+  // Margins reaching past the neighbouring tile rows hold back more tile rows before they are copied back
+  ca_lib_set_tile_size(blocked, 4);
+  for (int step = 0; step < 9; step++) { ca_lib_simulate_rows(plain, life_row); }
+  ca_lib_simulate_rows_blocked(blocked, life_row, 9);
+  for (size_t i = 0; i < w * h; i++)
+  {
+    equal &= *(unsigned char *)ca_lib_get_cell_data(plain, i % w, i / w).ptr == *(unsigned char *)ca_lib_get_cell_data(blocked, i % w, i / w).ptr;
+  }
+  CU_ASSERT(equal);
+  CU_ASSERT_EQUAL(ca_lib_get_generation(blocked), 29);
+  plain = ca_lib_destroy_grid(plain);
+  blocked = ca_lib_destroy_grid(blocked);
+}
+
+// Life written against the neighbourhood - only right if every neighbour is still the previous generation
+static void life_sync(ca_lib_grid_t *grid, data_t *data, const ca_lib_neighbourhood_t *neighbourhood)
+{
+  int n = 0;
+  for (int dy = -1; dy <= 1; dy++)
+  {
+    for (int dx = -1; dx <= 1; dx++)
+    {
+      unsigned char *neighbour = ca_lib_neighbour(neighbourhood, dx, dy);
+      n += (dx || dy) && neighbour && *neighbour;
+    }
+  }
+  *(unsigned char *)data->ptr = n == 3 || (n == 2 && *(unsigned char *)ca_lib_neighbour(neighbourhood, 0, 0));
+}
+
+void test_simulate_sync()
+{
+  size_t w = 23, h = 19;
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, w, h, 1);
+  ca_lib_simulate_sync(grid, CA_LIB_MOORE, 1, life_sync);
+  CU_ASSERT_EQUAL(ca_lib_get_generation(grid), 0); // Not enabled
+  ca_lib_enable_double_buffer(grid);
+  ca_lib_set_thread_count(grid, 4);
+  bool *expected = calloc(w * h, sizeof(bool));
+  unsigned char one = 1;
+  srand(3);
+  for (size_t i = 0; i < w * h; i++)
+  {
+    expected[i] = rand() % 3 == 0;
+    if (expected[i]) { ca_lib_insert_cell(grid, i % w, i / w, 1, &one); }
+  }
+  bool equal = true;
+  for (int step = 0; step < 10; step++)
+  {
+    if (step == 5) { ca_lib_set_thread_count(grid, 2); } // The bands kept with the grid are planned anew
+    ca_lib_simulate_sync(grid, CA_LIB_MOORE, 1, life_sync);
+    reference_life_step(expected, w, h, CA_LIB_LIFE_BIRTH, CA_LIB_LIFE_SURVIVAL);
+    for (size_t i = 0; i < w * h; i++)
+    {
+      equal &= *(unsigned char *)ca_lib_get_cell_data(grid, i % w, i / w).ptr == expected[i];
+    }
+  }
+  CU_ASSERT(equal);
+  free(expected);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+struct sum_job
+{
+  ca_lib_grid_t *grid;
+  size_t index;
+  size_t result;
+};
+
+static void sum_job(void *job)
+{
+  struct sum_job *sj = job;
+  sj->result = 0;
+  for (size_t i = 0; i <= sj->index * 100; i++) { sj->result += i; } // Uneven jobs, so there is something to steal
+}
+
+static void nested_job(void *job)
+{
+  struct sum_job *sj = job;
+  struct sum_job inner[3] = {{sj->grid, 1, 0}, {sj->grid, 2, 0}, {sj->grid, 3, 0}};
+  ca_lib_run_jobs(sj->grid, sum_job, inner, sizeof(struct sum_job), 3); // Runs inline rather than deadlocking
+  sj->result = inner[0].result + inner[1].result + inner[2].result;
+}
+
+void test_run_jobs()
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 4, 4, 1);
+  ca_lib_set_thread_count(grid, 4);
+  struct sum_job jobs[37];
+  bool correct = true;
+#ifdef __linux__
+  cpu_set_t before, after;
+  sched_getaffinity(0, sizeof(cpu_set_t), &before);
+#endif
+  for (int round = 0; round < 200; round++) // The same threads every round
+  {
+    if (round == 100) { ca_lib_set_thread_count(grid, 3); }
+    if (round == 150) { ca_lib_set_thread_affinity(grid, true); }
+    for (size_t i = 0; i < 37; i++) { jobs[i] = (struct sum_job){grid, i, 1}; }
+    ca_lib_run_jobs(grid, sum_job, jobs, sizeof(struct sum_job), 37);
+    for (size_t i = 0; i < 37; i++) { correct &= jobs[i].result == (i * 100) * (i * 100 + 1) / 2; }
+  }
+  CU_ASSERT(correct);
+#ifdef __linux__
+  sched_getaffinity(0, sizeof(cpu_set_t), &after);
+  CU_ASSERT(CPU_EQUAL(&before, &after)); // Pinned only while it ran the jobs
+#endif
+
+  for (size_t i = 0; i < 4; i++) { jobs[i] = (struct sum_job){grid, i, 0}; }
+  ca_lib_run_jobs(grid, nested_job, jobs, sizeof(struct sum_job), 4);
+  CU_ASSERT_EQUAL(jobs[3].result, 5050 + 20100 + 45150);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+// Non-zero bytes fall into empty cells below, straight or - for odd values - diagonally, with their value as priority
+static void intend_fall(ca_lib_grid_t *grid, const data_t *data, ca_lib_intent_t *intent)
+{
+  unsigned char value = *(unsigned char *)data->ptr;
+  if (value == 0 || data->y == 0) { return; }
+  int options[2] = {0, value % 2 ? 1 : -1};
+  for (int o = 0; o < 2; o++)
+  {
+    int dx = options[o];
+    if (!ca_lib_check_limits(grid, data->x + dx, data->y - 1)) { continue; }
+    if (*(unsigned char *)ca_lib_get_cell_data(grid, data->x + dx, data->y - 1).ptr == 0)
+    {
+      *intent = (ca_lib_intent_t){dx, -1, value};
+      return;
+    }
+  }
+}
+
+// Non-zero bytes want to move down whatever is there
+static void intend_down(ca_lib_grid_t *grid, const data_t *data, ca_lib_intent_t *intent)
+{
+  unsigned char value = *(unsigned char *)data->ptr;
+  if (value != 0) { *intent = (ca_lib_intent_t){0, -1, value}; }
+}
+
+static unsigned char byte_at(ca_lib_grid_t *grid, size_t x, size_t y)
+{
+  return *(unsigned char *)ca_lib_get_cell_data(grid, x, y).ptr;
+}
+
+void test_intents_resolve_conflicts()
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 3, 2, 1);
+  unsigned char heavy = 4, light = 3, floor = 2;
+  ca_lib_insert_cell(grid, 0, 0, 1, &floor);
+  ca_lib_insert_cell(grid, 0, 1, 1, &light); // Wants (1,0) diagonally
+  ca_lib_insert_cell(grid, 1, 1, 1, &heavy); // Wants (1,0) straight down
+  ca_lib_simulate_intents(grid, intend_fall);
+  CU_ASSERT_EQUAL(byte_at(grid, 1, 0), heavy);
+  CU_ASSERT_EQUAL(byte_at(grid, 0, 1), light); // Lost, stays put
+  grid = ca_lib_destroy_grid(grid);
+
+  // A chain - the middle cell moves down, so the top one waits rather than swapping it back up
+  grid = ca_lib_create_typed_grid(NULL, 1, 3, 1);
+  unsigned char top = 9, middle = 5;
+  ca_lib_insert_cell(grid, 0, 2, 1, &top);
+  ca_lib_insert_cell(grid, 0, 1, 1, &middle);
+  ca_lib_simulate_intents(grid, intend_down);
+  CU_ASSERT_EQUAL(byte_at(grid, 0, 0), middle);
+  CU_ASSERT_EQUAL(byte_at(grid, 0, 1), 0);
+  CU_ASSERT_EQUAL(byte_at(grid, 0, 2), top);
+  ca_lib_simulate_intents(grid, intend_down); // Follows into the emptied cell
+  CU_ASSERT_EQUAL(byte_at(grid, 0, 1), top);
+  CU_ASSERT_EQUAL(byte_at(grid, 0, 2), 0);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+// Fill a grid with falling bytes and let them settle on 'thread_count' threads
+static ca_lib_grid_t *fallen_grid(size_t thread_count)
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 31, 23, 1);
+  ca_lib_set_thread_count(grid, thread_count);
+  ca_lib_set_classifier(grid, 2, byte_class);
+  srand(17);
+  for (size_t i = 0; i < 31 * 23; i++)
+  {
+    unsigned char value = rand() % 4 == 0 ? 1 + rand() % 2 : 0;
+    ca_lib_insert_cell(grid, i % 31, i / 31, 1, &value);
+  }
+  for (int step = 0; step < 30; step++)
+  {
+    if (step == 15 && thread_count > 1) { ca_lib_set_thread_count(grid, 3); } // The bands are split anew mid-run
+    ca_lib_simulate_intents(grid, intend_fall);
+  }
+  return grid;
+}
+
+void test_intents_are_deterministic()
+{
+  ca_lib_grid_t *single = fallen_grid(1);
+  ca_lib_grid_t *parallel = fallen_grid(4);
+  bool same = true;
+  size_t count = 0;
+  for (size_t i = 0; i < 31 * 23; i++)
+  {
+    same &= byte_at(single, i % 31, i / 31) == byte_at(parallel, i % 31, i / 31);
+    count += byte_at(single, i % 31, i / 31) != 0;
+  }
+  CU_ASSERT(same);
+  CU_ASSERT_EQUAL(ca_lib_get_population(single, 0), 31 * 23 - count); // Cells only ever swap
+  single = ca_lib_destroy_grid(single);
+  parallel = ca_lib_destroy_grid(parallel);
+}
+
+// Turn the block a quarter clockwise - entries are (x,y), (x+1,y), (x,y+1), (x+1,y+1)
+static void rotate_block(ca_lib_grid_t *grid, data_t block[4])
+{
+  data_t first = block[0];
+  block[0] = block[1];
+  block[1] = block[3];
+  block[3] = block[2];
+  block[2] = first;
+}
+
+void test_margolus_alternates_offset()
+{
+  ca_lib_grid_t *grid = ca_lib_create_typed_grid(NULL, 4, 3, 1);
+  ca_lib_set_thread_count(grid, 2);
+  for (unsigned char i = 0; i < 12; i++) { ca_lib_insert_cell(grid, i % 4, i / 4, 1, &i); }
+
+  // Even generation - blocks at (0,0) and (2,0), row 2 doesn't fit
+  ca_lib_simulate_margolus(grid, rotate_block);
+  unsigned char even[12] = {1, 5, 3, 7, 0, 4, 2, 6, 8, 9, 10, 11};
+  bool equal = true;
+  for (size_t i = 0; i < 12; i++) { equal &= byte_at(grid, i % 4, i / 4) == even[i]; }
+  CU_ASSERT(equal);
+
+  // Odd generation - the one block at (1,1)
+  ca_lib_simulate_margolus(grid, rotate_block);
+  unsigned char odd[12] = {1, 5, 3, 7, 0, 2, 10, 6, 8, 4, 9, 11};
+  equal = true;
+  for (size_t i = 0; i < 12; i++) { equal &= byte_at(grid, i % 4, i / 4) == odd[i]; }
+  CU_ASSERT(equal);
+  CU_ASSERT_EQUAL(ca_lib_get_generation(grid), 2);
+  grid = ca_lib_destroy_grid(grid);
+}
+
+void test_margolus_moves_pointers()
+{
+  ca_lib_grid_t *grid = ca_lib_create_grid(NULL, 6, 6, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+  ca_lib_set_thread_count(grid, 3);
+  for (int i = 0; i < 36; i++) { ca_lib_insert_cell(grid, i % 6, i / 6, sizeof(int), &i); }
+  void *ptr = ca_lib_get_cell_data(grid, 2, 2).ptr;
+  ca_lib_simulate_margolus(grid, rotate_block);
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 2, 3).ptr, ptr);
+  ca_lib_set_thread_count(grid, 2); // The bands are split anew
+  for (int step = 0; step < 3; step++) { ca_lib_simulate_margolus(grid, rotate_block); } // Round the corner the blocks share and back
+  CU_ASSERT_PTR_EQUAL(ca_lib_get_cell_data(grid, 2, 2).ptr, ptr);
+  bool all_there = true;
+  for (int i = 0; i < 36; i++) { all_there &= !ca_lib_cell_empty(grid, i % 6, i / 6); }
+  CU_ASSERT(all_there);
+  grid = ca_lib_destroy_grid(grid);
+}
+
 int main()
 {
   CU_pSuite test_suite1 = NULL;
@@ -230,6 +1450,43 @@ int main()
       (NULL == CU_add_test(test_suite1, "test_switch_cells", test_switch_cells)) ||
       (NULL == CU_add_test(test_suite1, "test_simulate_unabstract", test_simulate_unabstract)) ||
       (NULL == CU_add_test(test_suite1, "test_simulate_abstract", test_simulate_abstract)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_abstract_moves_once", test_simulate_abstract_moves_once)) ||
+      (NULL == CU_add_test(test_suite1, "test_typed_grid_insert_switch", test_typed_grid_insert_switch)) ||
+      (NULL == CU_add_test(test_suite1, "test_typed_grid_move_clear", test_typed_grid_move_clear)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_unabstract_parallel", test_simulate_unabstract_parallel)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_phased", test_simulate_phased)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_active_skips_settled_chunks", test_simulate_active_skips_settled_chunks)) ||
+      (NULL == CU_add_test(test_suite1, "test_bit_grid_blinker", test_bit_grid_blinker)) ||
+      (NULL == CU_add_test(test_suite1, "test_bit_grid_matches_reference", test_bit_grid_matches_reference)) ||
+      (NULL == CU_add_test(test_suite1, "test_compile_rule", test_compile_rule)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_rule_matches_bit_grid", test_simulate_rule_matches_bit_grid)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_rule_honours_boundary", test_simulate_rule_honours_boundary)) ||
+      (NULL == CU_add_test(test_suite1, "test_hashlife_glider", test_hashlife_glider)) ||
+      (NULL == CU_add_test(test_suite1, "test_hashlife_matches_bit_grid", test_hashlife_matches_bit_grid)) ||
+      (NULL == CU_add_test(test_suite1, "test_elementary_matches_reference", test_elementary_matches_reference)) ||
+      (NULL == CU_add_test(test_suite1, "test_totalistic_matches_reference", test_totalistic_matches_reference)) ||
+      (NULL == CU_add_test(test_suite1, "test_elementary_write_history", test_elementary_write_history)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_neighbourhood", test_simulate_neighbourhood)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_rows", test_simulate_rows)) ||
+      (NULL == CU_add_test(test_suite1, "test_boundary", test_boundary)) ||
+      (NULL == CU_add_test(test_suite1, "test_boundary_follows_pointer_cells", test_boundary_follows_pointer_cells)) ||
+      (NULL == CU_add_test(test_suite1, "test_rule_assigned_data_is_kept", test_rule_assigned_data_is_kept)) ||
+      (NULL == CU_add_test(test_suite1, "test_pooled_allocator", test_pooled_allocator)) ||
+      (NULL == CU_add_test(test_suite1, "test_interned_cells", test_interned_cells)) ||
+      (NULL == CU_add_test(test_suite1, "test_arena_reset", test_arena_reset)) ||
+      (NULL == CU_add_test(test_suite1, "test_ownership_transfer", test_ownership_transfer)) ||
+      (NULL == CU_add_test(test_suite1, "test_random_is_reproducible", test_random_is_reproducible)) ||
+      (NULL == CU_add_test(test_suite1, "test_state_hash_finds_cycles", test_state_hash_finds_cycles)) ||
+      (NULL == CU_add_test(test_suite1, "test_run_until_stable_stops_early", test_run_until_stable_stops_early)) ||
+      (NULL == CU_add_test(test_suite1, "test_population_counts", test_population_counts)) ||
+      (NULL == CU_add_test(test_suite1, "test_population_follows_engines", test_population_follows_engines)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_rows_blocked", test_simulate_rows_blocked)) ||
+      (NULL == CU_add_test(test_suite1, "test_simulate_sync", test_simulate_sync)) ||
+      (NULL == CU_add_test(test_suite1, "test_run_jobs", test_run_jobs)) ||
+      (NULL == CU_add_test(test_suite1, "test_intents_resolve_conflicts", test_intents_resolve_conflicts)) ||
+      (NULL == CU_add_test(test_suite1, "test_intents_are_deterministic", test_intents_are_deterministic)) ||
+      (NULL == CU_add_test(test_suite1, "test_margolus_alternates_offset", test_margolus_alternates_offset)) ||
+      (NULL == CU_add_test(test_suite1, "test_margolus_moves_pointers", test_margolus_moves_pointers)) ||
       0)
   {
     CU_cleanup_registry();
@@ -0,0 +1,235 @@
+#define _GNU_SOURCE // pthread_setaffinity_np
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "ca_lib_threads.h"
+
+/*----USER NON-REACHABLE DATATYPES----*/
+
+// A worker's share of the batch - the jobs ['head', 'tail'), the owner takes from the head and thieves from the tail
+struct deque
+{
+    pthread_mutex_t lock;
+    size_t head;
+    size_t tail;
+};
+typedef struct deque deque_t;
+
+struct worker_thread
+{
+    ca_lib_thread_pool_t *pool;
+    size_t index;
+    pthread_t thread;
+};
+typedef struct worker_thread worker_thread_t;
+
+struct thread_pool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t wake; // Signalled when a batch is handed out or the pool is stopping
+    pthread_cond_t done; // Signalled when the last worker thread is done with the batch
+    size_t thread_count;
+    worker_thread_t *workers; // Worker 0 is whoever calls 'ca_lib_thread_pool_run', the rest are threads of the pool
+    deque_t *deques; // One per worker
+    void (*job_func)(void *job);
+    char *jobs;
+    size_t job_size;
+    unsigned long batch; // Counts the batches, so a waking worker can tell a new one from a spurious wakeup
+    size_t busy; // Worker threads not yet done with the batch
+    bool running; // A batch is under way
+    bool stopping;
+    bool pin; // Worker i runs on CPU i - the caller too, for as long as it works through a batch
+};
+
+// The worker the current thread is, NULL on threads no pool started
+static _Thread_local const worker_thread_t *current_worker;
+
+/*----STATIC HELPER FUNCTIONS----*/
+
+// The next job from the worker's own deque, or one stolen from another's
+static bool take_job(ca_lib_thread_pool_t *pool, size_t worker, size_t *job)
+{
+    for (size_t k = 0; k < pool->thread_count; k++)
+    {
+        deque_t *deque = &pool->deques[(worker + k) % pool->thread_count];
+        pthread_mutex_lock(&deque->lock);
+        bool found = deque->head < deque->tail;
+        if (found) { *job = k == 0 ? deque->head++ : --deque->tail; }
+        pthread_mutex_unlock(&deque->lock);
+        if (found) { return true; }
+    }
+    return false;
+}
+
+// No jobs are added during a batch, so once every deque is empty there is nothing left to steal
+static void work(ca_lib_thread_pool_t *pool, size_t worker)
+{
+    size_t job;
+    while (take_job(pool, worker, &job))
+    {
+        pool->job_func(pool->jobs + job * pool->job_size);
+    }
+}
+
+static void *worker_main(void *arg)
+{
+    worker_thread_t *worker = arg;
+    ca_lib_thread_pool_t *pool = worker->pool;
+    unsigned long seen = 0;
+    current_worker = worker;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true)
+    {
+        while (pool->batch == seen && !pool->stopping) { pthread_cond_wait(&pool->wake, &pool->lock); }
+        if (pool->stopping) { break; }
+        seen = pool->batch;
+        pthread_mutex_unlock(&pool->lock);
+
+        work(pool, worker->index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) { pthread_cond_signal(&pool->done); }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+static void pin_thread(pthread_t thread, size_t index)
+{
+#ifdef __linux__
+    long cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpu_count < 1) { return; }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index % cpu_count, &cpus);
+    pthread_setaffinity_np(thread, sizeof(cpu_set_t), &cpus);
+#else
+    (void)thread;
+    (void)index;
+#endif
+}
+
+// Pins the calling thread to worker 0's CPU, returns whether its previous mask was saved to 'saved' for 'unpin_caller'
+static bool pin_caller(void *saved)
+{
+#ifdef __linux__
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), saved) != 0) { return false; }
+    pin_thread(pthread_self(), 0);
+    return true;
+#else
+    (void)saved;
+    return false;
+#endif
+}
+
+static void unpin_caller(const void *saved)
+{
+#ifdef __linux__
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), saved);
+#else
+    (void)saved;
+#endif
+}
+
+/*----PUBLIC LIBRARY FUNCTIONS----*/
+
+ca_lib_thread_pool_t *ca_lib_create_thread_pool(size_t thread_count, bool pin)
+{
+    ca_lib_thread_pool_t *pool = calloc(1, sizeof(ca_lib_thread_pool_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->thread_count = thread_count > 0 ? thread_count : 1;
+    pool->pin = pin;
+    pool->workers = calloc(pool->thread_count, sizeof(worker_thread_t));
+    pool->deques = calloc(pool->thread_count, sizeof(deque_t));
+    for (size_t i = 0; i < pool->thread_count; i++)
+    {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (i == 0) { continue; } // The caller's own thread, pinned by 'ca_lib_thread_pool_run'
+        pthread_create(&pool->workers[i].thread, NULL, worker_main, &pool->workers[i]);
+        if (pin) { pin_thread(pool->workers[i].thread, i); }
+    }
+    return pool;
+}
+
+ca_lib_thread_pool_t *ca_lib_destroy_thread_pool(ca_lib_thread_pool_t *pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->thread_count; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (size_t i = 0; i < pool->thread_count; i++)
+    {
+        pthread_mutex_destroy(&pool->deques[i].lock);
+    }
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->deques);
+    free(pool->workers);
+    free(pool);
+    return NULL;
+}
+
+size_t ca_lib_thread_pool_size(ca_lib_thread_pool_t *pool)
+{
+    return pool->thread_count;
+}
+
+size_t ca_lib_thread_pool_worker(ca_lib_thread_pool_t *pool)
+{
+    return current_worker && current_worker->pool == pool ? current_worker->index : 0;
+}
+
+// Every worker starts out with a contiguous run of jobs, so neighbouring bands or tiles tend to stay on one thread
+void ca_lib_thread_pool_run(ca_lib_thread_pool_t *pool, void (*job_func)(void *job), void *jobs, size_t job_size, size_t job_count)
+{
+    pthread_mutex_lock(&pool->lock);
+    if (pool->running || pool->thread_count == 1)
+    {
+        pthread_mutex_unlock(&pool->lock);
+        for (size_t i = 0; i < job_count; i++)
+        {
+            job_func((char *)jobs + i * job_size);
+        }
+        return;
+    }
+    pool->running = true;
+    pool->job_func = job_func;
+    pool->jobs = jobs;
+    pool->job_size = job_size;
+    for (size_t w = 0; w < pool->thread_count; w++)
+    {
+        pool->deques[w].head = job_count * w / pool->thread_count;
+        pool->deques[w].tail = job_count * (w + 1) / pool->thread_count;
+    }
+    pool->busy = pool->thread_count - 1;
+    pool->batch++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    // The caller is worker 0 only for the batch - it gets its own mask back afterwards
+#ifdef __linux__
+    cpu_set_t saved;
+#else
+    char saved;
+#endif
+    bool pinned = pool->pin && pin_caller(&saved);
+    work(pool, 0);
+    if (pinned) { unpin_caller(&saved); }
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy > 0) { pthread_cond_wait(&pool->done, &pool->lock); } // The barrier at the end of the batch
+    pool->running = false;
+    pthread_mutex_unlock(&pool->lock);
+}
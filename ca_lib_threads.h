@@ -0,0 +1,43 @@
+#pragma once
+#include <stdlib.h>
+#include <stdbool.h>
+
+// ca-lib threads - persistent worker threads behind the parallel engines and 'ca_lib_run_jobs'
+// Not part of the user-reachable interface, every grid simulated on more than one thread gets a pool of its own
+
+typedef struct thread_pool ca_lib_thread_pool_t;
+
+/// @brief Starts 'thread_count' - 1 worker threads, which sleep until jobs are handed to them - the caller of
+/// 'ca_lib_thread_pool_run' is the last worker
+/// @param thread_count at least 1
+/// @param pin pin worker i to CPU i, where the platform supports it - the caller is pinned to CPU 0 only while it runs
+/// a batch in 'ca_lib_thread_pool_run', and gets its previous affinity back afterwards
+/// @return the allocated pool
+ca_lib_thread_pool_t *ca_lib_create_thread_pool(size_t thread_count, bool pin);
+
+/// @brief Stops and joins the worker threads - no jobs may be running
+/// @param pool
+/// @return NULL
+ca_lib_thread_pool_t *ca_lib_destroy_thread_pool(ca_lib_thread_pool_t *pool);
+
+/// @brief Number of threads the pool runs jobs on, the calling thread included
+/// @param pool
+/// @return the thread count
+size_t ca_lib_thread_pool_size(ca_lib_thread_pool_t *pool);
+
+/// @brief Index of the calling thread among the pool's workers - 0 for the caller of 'ca_lib_thread_pool_run' and any
+/// other thread that isn't one of the pool's. Lets jobs pick per-thread scratch, no two threads running the pool's jobs at
+/// once share an index as long as one thread at a time submits jobs.
+/// @param pool
+/// @return the index, less than 'ca_lib_thread_pool_size'
+size_t ca_lib_thread_pool_worker(ca_lib_thread_pool_t *pool);
+
+/// @brief Runs 'job_func' on all 'job_count' jobs (each 'job_size' bytes large, stored in 'jobs') and returns when all are done
+/// The jobs are split into one contiguous run per worker, and workers that run out steal from the others. Jobs submitted
+/// from inside a job, or while another thread is running jobs on the pool, run on the calling thread alone.
+/// @param pool
+/// @param job_func
+/// @param jobs
+/// @param job_size
+/// @param job_count
+void ca_lib_thread_pool_run(ca_lib_thread_pool_t *pool, void (*job_func)(void *job), void *jobs, size_t job_size, size_t job_count);
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include "ca_lib.h"
 #include <unistd.h>
+#include <string.h>
 #include "graphics/gfx/gfx.h"
 
 // #define Sim_width 10
@@ -15,14 +16,8 @@ enum blocks
 };
 typedef enum blocks blocks_t;
 
-struct sand_sim_meta_data
-{
-    int rock_count;
-    int sand_count;
-    int water_count;
-    int air_count;
-};
-typedef struct sand_sim_meta_data ss_meta_data_t;
+// Every block is its own class - the grid keeps count of them, see 'ca_lib_set_classifier'
+#define BLOCK_CLASSES (Rock + 1)
 
 void greeting()
 {
@@ -31,46 +26,37 @@ void greeting()
 
 void generate_cell_value(ca_lib_grid_t *grid, data_t *data)
 {
-    ss_meta_data_t *md = ca_lib_get_meta_data(grid);
-    int r = rand() % 10;
+    int r = ca_lib_random(grid, data->x, data->y, 0) % 10;
+    blocks_t block;
     if (r > 2)
     {
-        data->ptr = calloc(1, sizeof(enum blocks));
-        *(enum blocks *)data->ptr = Air;
-        data->size = sizeof(enum blocks);
-        md->air_count++;
+        block = Air;
     }
     else if (r == 0)
     {
-        data->ptr = calloc(1, sizeof(enum blocks));
-        *(enum blocks *)data->ptr = Water;
-        data->size = sizeof(enum blocks);
-        md->water_count++;
+        block = Water;
     }
     else if (r == 1)
     {
-        data->ptr = calloc(1, sizeof(enum blocks));
-        *(enum blocks *)data->ptr = Sand;
-        data->size = sizeof(enum blocks);
-        md->sand_count++;
+        block = Sand;
     }
-    else if (r == 2)
+    else
     {
-        data->ptr = calloc(1, sizeof(enum blocks));
-        *(enum blocks *)data->ptr = Rock;
-        data->size = sizeof(enum blocks);
-        md->rock_count++;
+        block = Rock;
     }
+    // Inserted rather than assigned to 'data->ptr', so every cell of the same block shares the grid's one interned payload
+    ca_lib_insert_cell(grid, data->x, data->y, sizeof(blocks_t), &block);
 }
 
 void update_water(ca_lib_grid_t *grid, data_t *data)
 {
     // Water can move sideways horizontally freely and randomly
-    bool sw_move = (ca_lib_check_limits(grid, data->x - 1, data->y) && *(blocks_t *)ca_lib_get_cell_data(grid, data->x - 1, data->y).ptr < *(blocks_t *)data->ptr);
-    bool se_move = (ca_lib_check_limits(grid, data->x + 1, data->y) && *(blocks_t *)ca_lib_get_cell_data(grid, data->x + 1, data->y).ptr < *(blocks_t *)data->ptr);
+    // The grid is walled in by rock (see 'initialize_sand_sim_grid'), so the neighbours can be read without checking limits
+    bool sw_move = *(blocks_t *)ca_lib_get_cell_data(grid, data->x - 1, data->y).ptr < *(blocks_t *)data->ptr;
+    bool se_move = *(blocks_t *)ca_lib_get_cell_data(grid, data->x + 1, data->y).ptr < *(blocks_t *)data->ptr;
     if (sw_move && se_move)
     {
-        float r = rand() % 10000 + 2000;
+        int r = ca_lib_random(grid, data->x, data->y, 0) % 2;
         if (r == 0) // w
         {
             ca_lib_switch_cells(grid, data->x, data->y, data->x - 1, data->y);
@@ -97,11 +83,11 @@ void update_water(ca_lib_grid_t *grid, data_t *data)
 void update_sand(ca_lib_grid_t *grid, data_t *data)
 {
     // Sand can move down diagonally
-    bool sw_move = (ca_lib_check_limits(grid, data->x - 1, data->y - 1) && *(blocks_t *)ca_lib_get_cell_data(grid, data->x - 1, data->y - 1).ptr < *(blocks_t *)data->ptr);
-    bool se_move = (ca_lib_check_limits(grid, data->x + 1, data->y - 1) && *(blocks_t *)ca_lib_get_cell_data(grid, data->x + 1, data->y - 1).ptr < *(blocks_t *)data->ptr);
+    bool sw_move = *(blocks_t *)ca_lib_get_cell_data(grid, data->x - 1, data->y - 1).ptr < *(blocks_t *)data->ptr;
+    bool se_move = *(blocks_t *)ca_lib_get_cell_data(grid, data->x + 1, data->y - 1).ptr < *(blocks_t *)data->ptr;
     if (sw_move && se_move)
     {
-        int r = rand() % 2;
+        int r = ca_lib_random(grid, data->x, data->y, 0) % 2;
         if (r == 0) // w
         {
             ca_lib_switch_cells(grid, data->x, data->y, data->x - 1, data->y - 1);
@@ -135,16 +121,12 @@ void update_block(ca_lib_grid_t *grid, data_t *data)
 
     blocks_t cell_block = *(blocks_t *)(ca_lib_get_cell_data(grid, data->x, data->y).ptr);
     
-    // All blocks fall down if there's nothing below
-    if (ca_lib_check_limits(grid, data->x, data->y - 1))
+    // All blocks fall down if the block below is lighter - the rock below the grid never is
+    blocks_t s_block = *(blocks_t *)(ca_lib_get_cell_data(grid, data->x, data->y - 1).ptr);
+    if (cell_block > s_block)
     {
-        // Switch if block below is lighter
-        blocks_t s_block = *(blocks_t *)(ca_lib_get_cell_data(grid, data->x, data->y - 1).ptr);
-        if (cell_block > s_block)
-        {
-            ca_lib_switch_cells(grid, data->x, data->y, data->x, data->y - 1);
-            return;
-        }
+        ca_lib_switch_cells(grid, data->x, data->y, data->x, data->y - 1);
+        return;
     }
 
     // Apply further physics to water and sand
@@ -158,6 +140,101 @@ void update_block(ca_lib_grid_t *grid, data_t *data)
     }
 }
 
+bool lighter_than(ca_lib_grid_t *grid, size_t x, size_t y, blocks_t block)
+{
+    return *(blocks_t *)ca_lib_get_cell_data(grid, x, y).ptr < block;
+}
+
+// The physics of 'update_block' stated as intents, so 'ca_lib_simulate_intents' can move every block at once
+// Falling straight down beats sliding down diagonally, which beats flowing sideways
+void intend_block(ca_lib_grid_t *grid, const data_t *data, ca_lib_intent_t *intent)
+{
+    blocks_t block = *(blocks_t *)data->ptr;
+    if (block == Air)
+    {
+        return;
+    }
+
+    if (lighter_than(grid, data->x, data->y - 1, block))
+    {
+        *intent = (ca_lib_intent_t){0, -1, 2};
+        return;
+    }
+    if (block != Sand && block != Water)
+    {
+        return;
+    }
+
+    // Sand slides down diagonally, water sideways
+    int dy = block == Sand ? -1 : 0;
+    bool w_move = lighter_than(grid, data->x - 1, data->y + dy, block);
+    bool e_move = lighter_than(grid, data->x + 1, data->y + dy, block);
+    int dx = 0;
+    if (w_move && e_move)
+    {
+        dx = ca_lib_random(grid, data->x, data->y, 0) % 2 ? 1 : -1;
+    }
+    else if (w_move)
+    {
+        dx = -1;
+    }
+    else if (e_move)
+    {
+        dx = 1;
+    }
+    *intent = (ca_lib_intent_t){dx, dy, block == Sand ? 1 : 0};
+}
+
+// Exchange the contents of two entries of a Margolus block
+void swap_entries(data_t *a, data_t *b)
+{
+    void *ptr = a->ptr;
+    size_t size = a->size;
+    a->ptr = b->ptr;
+    a->size = b->size;
+    b->ptr = ptr;
+    b->size = size;
+}
+
+blocks_t entry_block(data_t *entry)
+{
+    return *(blocks_t *)entry->ptr;
+}
+
+// The physics of 'update_block' for 'ca_lib_simulate_margolus' - 'block[0]' and 'block[1]' are the bottom row
+void update_margolus_block(ca_lib_grid_t *grid, data_t block[4])
+{
+    // All blocks fall down if the block below is lighter
+    for (int x = 0; x < 2; x++)
+    {
+        if (entry_block(&block[2 + x]) > entry_block(&block[x]))
+        {
+            swap_entries(&block[2 + x], &block[x]);
+        }
+    }
+
+    // Sand that couldn't fall slides down diagonally
+    for (int x = 0; x < 2; x++)
+    {
+        if (entry_block(&block[2 + x]) == Sand && entry_block(&block[1 - x]) < Sand)
+        {
+            swap_entries(&block[2 + x], &block[1 - x]);
+        }
+    }
+
+    // Water flows sideways into air half of the time - the alternating blocks take it both ways
+    for (int y = 0; y < 2; y++)
+    {
+        data_t *w = &block[2 * y];
+        data_t *e = &block[2 * y + 1];
+        bool flows = (entry_block(w) == Water && entry_block(e) == Air) || (entry_block(e) == Water && entry_block(w) == Air);
+        if (flows && ca_lib_random(grid, w->x, w->y, 1) % 2)
+        {
+            swap_entries(w, e);
+        }
+    }
+}
+
 char block_to_char(void *data_ptr)
 {
     if (*(enum blocks *)data_ptr == Air)
@@ -180,10 +257,19 @@ char block_to_char(void *data_ptr)
     return '?'; // Non-standard behaviour
 }
 
+size_t classify_block(void *data_ptr, size_t data_size)
+{
+    (void)data_size;
+    return *(blocks_t *)data_ptr;
+}
+
 ca_lib_grid_t *initialize_sand_sim_grid(size_t width, size_t height)
 {
-    ss_meta_data_t *meta_data = calloc(1, sizeof(ss_meta_data_t));
-    ca_lib_grid_t *grid = ca_lib_create_grid(meta_data, width, height, ca_lib_alloc_simple_ptr, ca_lib_free_simple_ptr);
+    ca_lib_grid_t *grid = ca_lib_create_grid(NULL, width, height, ca_lib_alloc_interned_ptr, ca_lib_free_interned_ptr);
+    blocks_t wall = Rock;
+    ca_lib_set_boundary(grid, CA_LIB_BOUNDARY_CONSTANT, sizeof(blocks_t), &wall);
+    ca_lib_set_classifier(grid, BLOCK_CLASSES, classify_block);
+    ca_lib_set_thread_count(grid, 4);
     ca_lib_simulate_unabstract(grid, generate_cell_value);
     return grid;
 }
@@ -192,10 +278,24 @@ void sand_simulate(ca_lib_grid_t *grid)
 {
     blocks_t insert_block = Water;
     ca_lib_insert_cell(grid, ca_lib_get_grid_height(grid) / 2, ca_lib_get_grid_height(grid) - 1, sizeof(blocks_t), &insert_block);
-    ca_lib_simulate(grid, update_block);
+    ca_lib_simulate_active(grid, update_block);
     //sleep(1);
 }
 
+void sand_simulate_intents(ca_lib_grid_t *grid)
+{
+    blocks_t insert_block = Water;
+    ca_lib_insert_cell(grid, ca_lib_get_grid_height(grid) / 2, ca_lib_get_grid_height(grid) - 1, sizeof(blocks_t), &insert_block);
+    ca_lib_simulate_intents(grid, intend_block);
+}
+
+void sand_simulate_margolus(ca_lib_grid_t *grid)
+{
+    blocks_t insert_block = Water;
+    ca_lib_insert_cell(grid, ca_lib_get_grid_height(grid) / 2, ca_lib_get_grid_height(grid) - 1, sizeof(blocks_t), &insert_block);
+    ca_lib_simulate_margolus(grid, update_margolus_block);
+}
+
 void color_convert(data_t *data, int *color)
 {
     if ((*(blocks_t *)data->ptr) == Water) // Blue
@@ -227,7 +327,16 @@ int main(int argc, char *argv[])
     size_t height = 1;
     size_t iterations = 1;
     size_t scale = 1;
-    if (argc == 5)
+    ca_lib_simulate_grid_t sim_func = sand_simulate;
+    if (argc == 6 && strcmp(argv[5], "margolus") == 0)
+    {
+        sim_func = sand_simulate_margolus;
+    }
+    if (argc == 6 && strcmp(argv[5], "intents") == 0)
+    {
+        sim_func = sand_simulate_intents;
+    }
+    if (argc == 5 || argc == 6)
     {
         width = atoi(argv[1]);
         height = atoi(argv[2]);
@@ -236,17 +345,17 @@ int main(int argc, char *argv[])
     }
     else
     {
-        printf("\nUsage: '%s [width] [height] [iterations] [scale]'", argv[0]);
+        printf("\nUsage: '%s [width] [height] [iterations] [scale] [margolus|intents]'", argv[0]);
         return 1;
     }
     greeting();
     ca_lib_grid_t *grid = initialize_sand_sim_grid(width, height);
     //printf("\033[%dB", (int)ca_lib_get_grid_height(grid) + 3);
-    ss_meta_data_t *md = ca_lib_get_meta_data(grid);
 
-    ca_lib_start_graphics_simulation(grid, color_convert, sand_simulate, iterations, scale);
-    
-    free(ca_lib_get_meta_data(grid));
+    ca_lib_start_graphics_simulation(grid, color_convert, sim_func, iterations, scale);
+    printf("\nRock: %zu Sand: %zu Water: %zu Air: %zu\n", ca_lib_get_population(grid, Rock), ca_lib_get_population(grid, Sand),
+           ca_lib_get_population(grid, Water), ca_lib_get_population(grid, Air));
+
     ca_lib_destroy_grid(grid);
     return 0;
 }
\ No newline at end of file